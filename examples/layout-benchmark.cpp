@@ -0,0 +1,85 @@
+/**
+ * Compares the column-major and row-major window layouts of
+ * CovarianceTracker over a range of dimensions and data lengths, in both
+ * update modes. Prints the average nanoseconds per addData() +
+ * getCovariance() pair, so the point where RowMajor starts to win shows up
+ * as the ratio column crossing 1.
+ *
+ * Build with optimizations, e.g.
+ *   g++ -std=c++11 -O3 -march=native -DNDEBUG -I<eigen>
+ *       -I../src/covariance-tracker/include/covariance-tracker
+ *       layout-benchmark.cpp
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include "covariance-tracker.h"
+
+template <int _Dimension, int _Layout>
+double nanosecondsPerSample(int len, bool incremental, int queries_every)
+{
+  typedef CovarianceTracker<float, _Dimension, float, _Layout> Tracker;
+  Tracker covTrack(len, incremental ? Tracker::INCREMENTAL
+                                    : Tracker::RECOMPUTE);
+
+  // fill the window first, so every timed insertion also evicts
+  std::vector<float> point(_Dimension);
+  for (int i = 0; i < len; ++i) {
+    for (int j = 0; j < _Dimension; ++j)
+      point[j] = static_cast<float>((i * 31 + j * 17) % 101);
+    covTrack.addData(point);
+  }
+
+  const int samples = 20000;
+  double sink = 0.0;
+  std::chrono::steady_clock::time_point start =
+    std::chrono::steady_clock::now();
+  for (int i = 0; i < samples; ++i) {
+    for (int j = 0; j < _Dimension; ++j)
+      point[j] = static_cast<float>((i * 13 + j * 7) % 97);
+    covTrack.addData(point);
+    if (i % queries_every == 0)
+      sink += covTrack.getCovariance()(0, 0);
+  }
+  std::chrono::steady_clock::time_point stop =
+    std::chrono::steady_clock::now();
+
+  // keep the optimizer from dropping the loop
+  if (sink == -1.0)
+    std::printf(" ");
+  return std::chrono::duration<double, std::nano>(stop - start).count()
+         / samples;
+}
+
+template <int _Dimension>
+void compareLayouts(int len, bool incremental, int queries_every)
+{
+  double col = nanosecondsPerSample<_Dimension, Eigen::ColMajor>(
+    len, incremental, queries_every);
+  double row = nanosecondsPerSample<_Dimension, Eigen::RowMajor>(
+    len, incremental, queries_every);
+  std::printf("%-12s %4d %8d %8d %12.1f %12.1f %8.2f\n",
+              incremental ? "INCREMENTAL" : "RECOMPUTE", _Dimension, len,
+              queries_every, col, row, col / row);
+}
+
+template <int _Dimension>
+void compareLengths(void)
+{
+  const int lengths[] = {16, 256, 4096, 65536};
+  for (int len : lengths) {
+    compareLayouts<_Dimension>(len, true, 1);
+    compareLayouts<_Dimension>(len, false, 1000);
+  }
+}
+
+int main()
+{
+  std::printf("%-12s %4s %8s %8s %12s %12s %8s\n", "mode", "dim", "len",
+              "query/n", "ColMajor ns", "RowMajor ns", "col/row");
+  compareLengths<3>();
+  compareLengths<12>();
+  compareLengths<64>();
+  return 0;
+}
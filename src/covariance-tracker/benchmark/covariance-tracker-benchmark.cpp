@@ -0,0 +1,368 @@
+/**
+ * Google Benchmark suite for CovarianceTracker's hot paths: the three
+ * addData() overloads, getCovariance(), getMean() and construction, for
+ * _Dimension in {1, 2, 3, 6, 12, 32}, float and double input, window
+ * lengths from 16 to 2^20 and both update modes.
+ *
+ * Every benchmark reports, besides ns per operation:
+ *   items_per_second   data (or queries, or constructions) per second
+ *   bytes_per_second   input bytes consumed per second, for addData()
+ *   alloc_bytes/op     bytes allocated on the heap per operation
+ *   allocs/op          heap allocations per operation
+ *   working_set        the bytes of the window buffers the operation walks
+ * and labels each run with the smallest cache level the working set fits in
+ * (L1d, L2, L3 or DRAM), so the steps where it falls out of a level line up
+ * with the timings.
+ *
+ * Window lengths whose buffers exceed kMaxWorkingSet are skipped. Filter
+ * the rest with e.g. --benchmark_filter='AddDataArray<double, 6>'.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "covariance-tracker/covariance-tracker.h"
+
+
+// Eigen allocates its heap matrices with malloc rather than operator new, so
+//  on glibc malloc itself is interposed to count every allocation made
+//  inside the timed loops. Elsewhere only operator new is counted.
+static std::atomic<uint64_t> g_alloc_bytes(0);
+static std::atomic<uint64_t> g_alloc_count(0);
+
+static void countAllocation(std::size_t size)
+{
+  g_alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+  g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+#if defined(__GLIBC__)
+extern "C" {
+void *__libc_malloc(std::size_t size);
+void *__libc_calloc(std::size_t count, std::size_t size);
+void *__libc_realloc(void *p, std::size_t size);
+
+void *malloc(std::size_t size)
+{
+  countAllocation(size);
+  return __libc_malloc(size);
+}
+
+void *calloc(std::size_t count, std::size_t size)
+{
+  countAllocation(count * size);
+  return __libc_calloc(count, size);
+}
+
+void *realloc(void *p, std::size_t size)
+{
+  countAllocation(size);
+  return __libc_realloc(p, size);
+}
+}
+#else
+void *operator new(std::size_t size)
+{
+  countAllocation(size);
+  if (void *p = std::malloc(size ? size : 1))
+    return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+  std::free(p);
+}
+#endif
+
+
+namespace
+{
+
+// The largest window buffer a benchmark may build, in bytes.
+const int64_t kMaxWorkingSet = int64_t(1) << 30;
+// The number of distinct data cycled through, so inputs are not constant.
+const int kPoolSize = 4096;
+
+/**
+ * Snapshots the allocation counters when constructed, and reports the
+ * per-iteration difference as counters in finish().
+ */
+class AllocationCounter
+{
+public:
+  AllocationCounter()
+    : bytes_(g_alloc_bytes.load(std::memory_order_relaxed)),
+      count_(g_alloc_count.load(std::memory_order_relaxed))
+  {
+  }
+
+  void finish(benchmark::State &state) const
+  {
+    const double bytes = static_cast<double>(
+      g_alloc_bytes.load(std::memory_order_relaxed) - bytes_);
+    const double count = static_cast<double>(
+      g_alloc_count.load(std::memory_order_relaxed) - count_);
+    state.counters["alloc_bytes/op"] = benchmark::Counter(
+      bytes, benchmark::Counter::kAvgIterations);
+    state.counters["allocs/op"] = benchmark::Counter(
+      count, benchmark::Counter::kAvgIterations);
+  }
+
+private:
+  const uint64_t bytes_;
+  const uint64_t count_;
+};
+
+/**
+ * int64_t workingSet(int dimension, int64_t len, bool incremental)
+ *
+ * @return The bytes of the tracker's window buffer, plus its residual
+ *         buffer in RECOMPUTE mode, the data a RECOMPUTE query walks.
+ */
+int64_t workingSet(int dimension, int64_t len, bool incremental)
+{
+  return (incremental ? 1 : 2) * len * dimension
+         * static_cast<int64_t>(sizeof(double));
+}
+
+/**
+ * void reportWorkingSet(benchmark::State &state, int dimension, int64_t len)
+ *
+ * Adds the working_set counter for the state's mode and labels the run
+ * with the smallest cache level that holds it.
+ */
+void reportWorkingSet(benchmark::State &state, int dimension, int64_t len)
+{
+  const int64_t bytes = workingSet(dimension, len, state.range(1) != 0);
+  state.counters["working_set"] = benchmark::Counter(
+    static_cast<double>(bytes), benchmark::Counter::kDefaults,
+    benchmark::Counter::kIs1024);
+
+  std::string level = "DRAM";
+  for (const benchmark::CPUInfo::CacheInfo &cache
+       : benchmark::CPUInfo::Get().caches) {
+    if (cache.type == "Instruction")
+      continue;
+    // shared caches are split between the cores that share them
+    const int64_t size = static_cast<int64_t>(cache.size)
+                         / std::max(cache.num_sharing, 1);
+    if (bytes <= size) {
+      level = (cache.level == 1) ? "L1d" : "L" + std::to_string(cache.level);
+      break;
+    }
+  }
+  state.SetLabel(level);
+}
+
+template <typename _Scalar, int _Dimension>
+struct Fixture
+{
+  typedef CovarianceTracker<_Scalar, _Dimension> Tracker;
+  typedef Eigen::Matrix<_Scalar, _Dimension, 1> Point;
+
+  std::vector<Point, Eigen::aligned_allocator<Point> > points;
+  std::vector<std::vector<_Scalar> > vectors;
+
+  Fixture()
+    : points(kPoolSize), vectors(kPoolSize)
+  {
+    for (int k = 0; k < kPoolSize; ++k) {
+      points[k] = Point::Random();
+      // correlate the first two variables so the covariance is not diagonal
+      if (_Dimension > 1)
+        points[k](1) += points[k](0);
+      vectors[k].assign(points[k].data(), points[k].data() + _Dimension);
+    }
+  }
+
+  /**
+   * Tracker *makeFullTracker(benchmark::State &state)
+   *
+   * Builds the tracker for the state's (len, mode) arguments and fills its
+   * window, so every timed insertion also evicts.
+   */
+  Tracker *makeFullTracker(benchmark::State &state) const
+  {
+    const int len = static_cast<int>(state.range(0));
+    Tracker *tracker = new Tracker(
+      len, state.range(1) ? Tracker::INCREMENTAL : Tracker::RECOMPUTE);
+    for (int i = 0; i < len; ++i)
+      tracker->addData(points[i % kPoolSize].data());
+    return tracker;
+  }
+};
+
+// One of the three addData() overloads, selected by _Overload.
+enum Overload { EIGEN, VECTOR, ARRAY };
+
+template <typename _Scalar, int _Dimension, int _Overload>
+void BM_AddData(benchmark::State &state)
+{
+  Fixture<_Scalar, _Dimension> fixture;
+  typename Fixture<_Scalar, _Dimension>::Tracker *tracker =
+    fixture.makeFullTracker(state);
+
+  int k = 0;
+  AllocationCounter allocations;
+  for (auto _ : state) {
+    double used;
+    if (_Overload == EIGEN)
+      used = tracker->addData(fixture.points[k]);
+    else if (_Overload == VECTOR)
+      used = tracker->addData(fixture.vectors[k]);
+    else
+      used = tracker->addData(fixture.points[k].data());
+    benchmark::DoNotOptimize(used);
+    k = (k + 1) & (kPoolSize - 1);
+  }
+  allocations.finish(state);
+
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * _Dimension * sizeof(_Scalar));
+  reportWorkingSet(state, _Dimension, state.range(0));
+  delete tracker;
+}
+
+// A query is only recomputed after an insertion, so each iteration inserts
+//  one datum and then queries; subtract BM_AddData<..., ARRAY> for the
+//  query alone.
+template <typename _Scalar, int _Dimension>
+void BM_GetCovariance(benchmark::State &state)
+{
+  Fixture<_Scalar, _Dimension> fixture;
+  typename Fixture<_Scalar, _Dimension>::Tracker *tracker =
+    fixture.makeFullTracker(state);
+
+  int k = 0;
+  AllocationCounter allocations;
+  for (auto _ : state) {
+    tracker->addData(fixture.points[k].data());
+    benchmark::DoNotOptimize(tracker->getCovariance().data());
+    k = (k + 1) & (kPoolSize - 1);
+  }
+  allocations.finish(state);
+
+  state.SetItemsProcessed(state.iterations());
+  reportWorkingSet(state, _Dimension, state.range(0));
+  delete tracker;
+}
+
+template <typename _Scalar, int _Dimension>
+void BM_GetMean(benchmark::State &state)
+{
+  Fixture<_Scalar, _Dimension> fixture;
+  typename Fixture<_Scalar, _Dimension>::Tracker *tracker =
+    fixture.makeFullTracker(state);
+
+  int k = 0;
+  AllocationCounter allocations;
+  for (auto _ : state) {
+    tracker->addData(fixture.points[k].data());
+    benchmark::DoNotOptimize(tracker->getMean().data());
+    k = (k + 1) & (kPoolSize - 1);
+  }
+  allocations.finish(state);
+
+  state.SetItemsProcessed(state.iterations());
+  reportWorkingSet(state, _Dimension, state.range(0));
+  delete tracker;
+}
+
+template <typename _Scalar, int _Dimension>
+void BM_Construct(benchmark::State &state)
+{
+  typedef CovarianceTracker<_Scalar, _Dimension> Tracker;
+  const int len = static_cast<int>(state.range(0));
+  const typename Tracker::UpdateMode mode =
+    state.range(1) ? Tracker::INCREMENTAL : Tracker::RECOMPUTE;
+
+  AllocationCounter allocations;
+  for (auto _ : state) {
+    Tracker tracker(len, mode);
+    benchmark::DoNotOptimize(&tracker);
+    benchmark::ClobberMemory();
+  }
+  allocations.finish(state);
+
+  state.SetItemsProcessed(state.iterations());
+  reportWorkingSet(state, _Dimension, state.range(0));
+}
+
+/**
+ * void windowArguments(benchmark::internal::Benchmark *b, int dimension)
+ *
+ * Adds (len, mode) pairs for len = 16, 256, ..., 2^20 and both modes,
+ * skipping windows whose buffers exceed kMaxWorkingSet.
+ */
+void windowArguments(benchmark::internal::Benchmark *b, int dimension)
+{
+  b->ArgNames({"len", "incremental"});
+  for (int64_t len = 16; len <= (int64_t(1) << 20); len *= 16)
+    for (int mode = 0; mode <= 1; ++mode)
+      if (workingSet(dimension, len, mode != 0) <= kMaxWorkingSet)
+        b->Args({len, mode});
+}
+
+template <typename _Scalar, int _Dimension>
+void registerDimension(const char *scalar)
+{
+  const std::string suffix = std::string("<") + scalar + ", "
+                             + std::to_string(_Dimension) + ">";
+  const auto arguments = [](benchmark::internal::Benchmark *b) {
+    windowArguments(b, _Dimension);
+  };
+
+  benchmark::RegisterBenchmark(("AddDataEigen" + suffix).c_str(),
+    BM_AddData<_Scalar, _Dimension, EIGEN>)->Apply(arguments);
+  benchmark::RegisterBenchmark(("AddDataVector" + suffix).c_str(),
+    BM_AddData<_Scalar, _Dimension, VECTOR>)->Apply(arguments);
+  benchmark::RegisterBenchmark(("AddDataArray" + suffix).c_str(),
+    BM_AddData<_Scalar, _Dimension, ARRAY>)->Apply(arguments);
+  benchmark::RegisterBenchmark(("GetCovariance" + suffix).c_str(),
+    BM_GetCovariance<_Scalar, _Dimension>)->Apply(arguments);
+  benchmark::RegisterBenchmark(("GetMean" + suffix).c_str(),
+    BM_GetMean<_Scalar, _Dimension>)->Apply(arguments);
+  benchmark::RegisterBenchmark(("Construct" + suffix).c_str(),
+    BM_Construct<_Scalar, _Dimension>)->Apply(arguments);
+}
+
+template <typename _Scalar>
+void registerScalar(const char *scalar)
+{
+  registerDimension<_Scalar, 1>(scalar);
+  registerDimension<_Scalar, 2>(scalar);
+  registerDimension<_Scalar, 3>(scalar);
+  registerDimension<_Scalar, 6>(scalar);
+  registerDimension<_Scalar, 12>(scalar);
+  registerDimension<_Scalar, 32>(scalar);
+}
+
+}  // namespace
+
+
+int main(int argc, char **argv)
+{
+  registerScalar<float>("float");
+  registerScalar<double>("double");
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    return 1;
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
@@ -0,0 +1,308 @@
+/**
+ * The AsyncCovarianceTracker class. Decouples a real-time producer, such as
+ * a sensor callback, from the covariance computation.
+ *
+ * The producer pushes data into a bounded lock-free single-producer /
+ * single-consumer ring, which is wait-free: a push is a copy and two atomic
+ * stores, and a full ring drops the datum and counts it instead of waiting.
+ * A dedicated worker thread drains the ring in contiguous runs through
+ * CovarianceTracker::addBatch() and publishes the results through a
+ * ConcurrentCovarianceTracker, so any thread can read them with
+ * readSnapshot().
+ *
+ * Uses std::thread, so link against the platform thread library (e.g.
+ * -pthread, or Threads::Threads in CMake).
+ *
+ * @author Vanderbilt Robotics
+ * @since October 2026
+ * @brief Wait-free ingestion with a background covariance thread.
+ */
+
+#ifndef ASYNCCOVARIANCETRACKER_H
+#define ASYNCCOVARIANCETRACKER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "concurrent-covariance-tracker.h"
+
+
+template <typename _Scalar, int _Dimension, typename _Storage = double,
+          int _Layout = Eigen::ColMajor>
+class AsyncCovarianceTracker
+{
+public:
+  typedef ConcurrentCovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+    Concurrent;
+  typedef typename Concurrent::Tracker Tracker;
+  typedef typename Concurrent::Snapshot Snapshot;
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  /**
+   * Constructor. Starts the worker thread.
+   *
+   * @param len The number of stored data in the windowed tracker.
+   * @param queue_capacity The number of data the ring holds; rounded up to a
+   *                       power of two. Defaults to 1024.
+   * @param mode How the tracker keeps its statistics current.
+   */
+  AsyncCovarianceTracker(int len = 100, int queue_capacity = 1024,
+                         typename Tracker::UpdateMode mode
+                         = Tracker::INCREMENTAL);
+
+  /**
+   * Constructor for a tracker whose dimension is chosen at runtime.
+   *
+   * @param len The number of stored data in the windowed tracker.
+   * @param dimension The number of variables in each datum.
+   * @param queue_capacity The number of data the ring holds; rounded up to a
+   *                       power of two.
+   * @param mode How the tracker keeps its statistics current.
+   */
+  AsyncCovarianceTracker(int len, int dimension, int queue_capacity,
+                         typename Tracker::UpdateMode mode
+                         = Tracker::INCREMENTAL);
+
+  /**
+   * Destructor. Lets the worker drain whatever is queued, then joins it.
+   */
+  ~AsyncCovarianceTracker();
+
+  AsyncCovarianceTracker(const AsyncCovarianceTracker &) = delete;
+  AsyncCovarianceTracker &operator=(const AsyncCovarianceTracker &) = delete;
+
+  /**
+   * bool push(const _Scalar point[])
+   *
+   * Producer thread only. Wait-free: never blocks and never allocates.
+   * @param point The getDimension() values of the datum to add.
+   * @return False if the ring was full and the datum was dropped.
+   */
+  bool push(const _Scalar point[]);
+
+  /**
+   * bool push(const Eigen::Matrix<_Scalar, _Dimension, 1> &point)
+   *
+   * Producer thread only. See push() above.
+   */
+  bool push(const Eigen::Matrix<_Scalar, _Dimension, 1> &point)
+  {
+    assert(point.size() == dimension_);
+    return push(point.data());
+  }
+
+  /**
+   * uint64_t readSnapshot(Snapshot &out) const
+   *
+   * Any thread. See ConcurrentCovarianceTracker::readSnapshot().
+   */
+  uint64_t readSnapshot(Snapshot &out) const
+  {
+    return tracker_.readSnapshot(out);
+  }
+
+  /**
+   * void flush(void)
+   *
+   * Producer thread. Waits until everything pushed so far has been added to
+   * the tracker and published. Not for real-time contexts.
+   */
+  void flush(void);
+
+  /**
+   * size_t getQueueDepth(void) const
+   *
+   * Any thread.
+   * @return The number of data waiting for the worker.
+   */
+  size_t getQueueDepth(void) const
+  {
+    // tail_ never passes head_, so reading it first keeps the difference
+    //  from wrapping if the worker advances between the loads
+    const size_t tail = tail_.load(std::memory_order_acquire);
+    return head_.load(std::memory_order_acquire) - tail;
+  }
+
+  /**
+   * size_t getQueueCapacity(void) const
+   *
+   * @return The number of data the ring holds.
+   */
+  size_t getQueueCapacity(void) const
+  {
+    return capacity_;
+  }
+
+  /**
+   * uint64_t getDropCount(void) const
+   *
+   * Any thread.
+   * @return The number of data push() dropped because the ring was full.
+   */
+  uint64_t getDropCount(void) const
+  {
+    return drops_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * int getDimension(void) const
+   *
+   * @return The dimension of the tracker.
+   */
+  int getDimension(void) const
+  {
+    return dimension_;
+  }
+
+private:
+  const int dimension_;
+  const size_t capacity_;  // A power of two.
+  const size_t mask_;
+  std::vector<_Scalar> ring_;  // capacity_ data back to back.
+
+  // The producer and the worker each own one index; the padding keeps them
+  //  on separate cache lines so they do not bounce between cores. (alignas
+  //  would over-align the class, which operator new only honors in C++17.)
+  char head_padding_[64];
+  std::atomic<size_t> head_;  // Next slot the producer writes.
+  size_t cached_tail_;  // The producer's last look at tail_.
+  std::atomic<uint64_t> drops_;
+  char tail_padding_[64];
+  std::atomic<size_t> tail_;  // Next slot the worker reads.
+  std::atomic<bool> stop_;
+  char end_padding_[64];
+
+  Concurrent tracker_;
+  std::thread worker_;
+
+  /**
+   * static size_t roundUpToPowerOfTwo(int n)
+   */
+  static size_t roundUpToPowerOfTwo(int n)
+  {
+    size_t size = 1;
+    while (size < static_cast<size_t>(n))
+      size <<= 1;
+    return size;
+  }
+
+  /**
+   * void run(void)
+   *
+   * The worker loop: drain the ring in contiguous runs, idle when empty,
+   * and exit once stopped and drained.
+   */
+  void run(void);
+};
+
+
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+AsyncCovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::AsyncCovarianceTracker(int len, int queue_capacity,
+                         typename Tracker::UpdateMode mode)
+  : AsyncCovarianceTracker(len, _Dimension, queue_capacity, mode)
+{
+}
+
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+AsyncCovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::AsyncCovarianceTracker(int len, int dimension, int queue_capacity,
+                         typename Tracker::UpdateMode mode)
+  : dimension_(dimension),
+    capacity_(roundUpToPowerOfTwo(queue_capacity)),
+    mask_(capacity_ - 1),
+    ring_(capacity_ * dimension),
+    head_padding_(),
+    head_(0),
+    cached_tail_(0),
+    drops_(0),
+    tail_padding_(),
+    tail_(0),
+    stop_(false),
+    end_padding_(),
+    tracker_(len, dimension, mode),
+    worker_()
+{
+  assert(queue_capacity > 0);
+  // start the worker last, once every member it touches exists
+  worker_ = std::thread(&AsyncCovarianceTracker::run, this);
+}
+
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+AsyncCovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::~AsyncCovarianceTracker()
+{
+  stop_.store(true, std::memory_order_release);
+  worker_.join();
+}
+
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+bool AsyncCovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::push(const _Scalar point[])
+{
+  const size_t head = head_.load(std::memory_order_relaxed);
+  if (head - cached_tail_ == capacity_) {
+    // only look at the worker's index when the stale copy says we are full
+    cached_tail_ = tail_.load(std::memory_order_acquire);
+    if (head - cached_tail_ == capacity_) {
+      drops_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+  }
+
+  _Scalar *slot = &ring_[(head & mask_) * dimension_];
+  for (int i = 0; i < dimension_; ++i)
+    slot[i] = point[i];
+  head_.store(head + 1, std::memory_order_release);
+  return true;
+}
+
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+void AsyncCovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::flush(void)
+{
+  const size_t target = head_.load(std::memory_order_relaxed);
+  while (tail_.load(std::memory_order_acquire) < target)
+    std::this_thread::yield();
+}
+
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+void AsyncCovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::run(void)
+{
+  int idle = 0;
+  for (;;) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    const size_t head = head_.load(std::memory_order_acquire);
+
+    if (head == tail) {
+      if (stop_.load(std::memory_order_acquire)
+          && head_.load(std::memory_order_acquire) == tail)
+        return;
+      // spin briefly for bursts, then back off so an idle tracker does not
+      //  burn a core
+      if (++idle < 64)
+        std::this_thread::yield();
+      else
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+      continue;
+    }
+    idle = 0;
+
+    // the queued data are back to back, so everything up to the end of the
+    //  ring goes in as one batch; a wrapped remainder is the next run
+    const size_t start = tail & mask_;
+    const size_t count = std::min(head - tail, capacity_ - start);
+    tracker_.addBatch(&ring_[start * dimension_], static_cast<int>(count));
+    tail_.store(tail + count, std::memory_order_release);
+  }
+}
+
+#endif // ASYNCCOVARIANCETRACKER_H
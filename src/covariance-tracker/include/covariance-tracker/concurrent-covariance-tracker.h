@@ -0,0 +1,273 @@
+/**
+ * The ConcurrentCovarianceTracker class. Wraps a CovarianceTracker that is
+ * fed by a single writer thread, and publishes versioned snapshots of its
+ * mean and covariance that any number of reader threads can take without
+ * locks.
+ *
+ * Each publication goes to one of two slots guarded by a sequence counter
+ * (a double-buffered seqlock), and an epoch counter names the newest slot.
+ * The writer never waits for readers. A reader copies the newest slot and
+ * only retries if the writer published twice more while it was copying, so
+ * every snapshot it returns is a consistent mean + covariance pair.
+ *
+ * @author Vanderbilt Robotics
+ * @since October 2026
+ * @brief Lock-free publication of covariance snapshots to many threads.
+ */
+
+#ifndef CONCURRENTCOVARIANCETRACKER_H
+#define CONCURRENTCOVARIANCETRACKER_H
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "covariance-tracker.h"
+
+
+template <typename _Scalar, int _Dimension, typename _Storage = double,
+          int _Layout = Eigen::ColMajor>
+class ConcurrentCovarianceTracker
+{
+public:
+  typedef CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout> Tracker;
+
+  /**
+   * One published state of the tracker.
+   */
+  struct Snapshot
+  {
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    Snapshot()
+      : epoch(0), fraction_used(0.0), mean(), covariance()
+    {
+    }
+
+    /**
+     * Sizes the matrices for a tracker with a runtime dimension, so reading
+     * into this snapshot never allocates.
+     */
+    explicit Snapshot(int dimension)
+      : epoch(0),
+        fraction_used(0.0),
+        mean(Eigen::Matrix<double, _Dimension, 1>::Zero(dimension)),
+        covariance(Eigen::Matrix<double, _Dimension, _Dimension>
+                   ::Zero(dimension, dimension))
+    {
+    }
+
+    uint64_t epoch;  // The number of publications up to this one.
+    double fraction_used;
+    Eigen::Matrix<double, _Dimension, 1> mean;
+    Eigen::Matrix<double, _Dimension, _Dimension> covariance;
+  };
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  /**
+   * Constructor. Defaults to INCREMENTAL mode, since every insertion
+   * publishes a fresh covariance.
+   *
+   * @param len The number of stored data in the windowed tracker.
+   * @param mode How the tracker keeps its statistics current.
+   */
+  ConcurrentCovarianceTracker(int len = 100,
+                              typename Tracker::UpdateMode mode
+                              = Tracker::INCREMENTAL);
+
+  /**
+   * Constructor for a tracker whose dimension is chosen at runtime.
+   *
+   * @param len The number of stored data in the windowed tracker.
+   * @param dimension The number of variables in each datum.
+   * @param mode How the tracker keeps its statistics current.
+   */
+  ConcurrentCovarianceTracker(int len, int dimension,
+                              typename Tracker::UpdateMode mode
+                              = Tracker::INCREMENTAL);
+
+  /**
+   * double addData(...)
+   *
+   * Writer thread only. Adds the datum to the tracker, like
+   * CovarianceTracker::addData(), and publishes the new mean and covariance.
+   * @return The fraction of the stored data matrix that is used.
+   */
+  double addData(const Eigen::Matrix<_Scalar, _Dimension, 1> &point)
+  {
+    double used = tracker_.addData(point);
+    publish();
+    return used;
+  }
+
+  double addData(const std::vector<_Scalar> &point)
+  {
+    double used = tracker_.addData(point);
+    publish();
+    return used;
+  }
+
+  double addData(const _Scalar point[])
+  {
+    double used = tracker_.addData(point);
+    publish();
+    return used;
+  }
+
+  /**
+   * double addBatch(...)
+   *
+   * Writer thread only. Adds the batch to the tracker, like
+   * CovarianceTracker::addBatch(), and publishes once for the whole batch.
+   * @return The fraction of the stored data matrix that is used.
+   */
+  double addBatch(const Eigen::Ref<
+                  const Eigen::Matrix<_Scalar, Eigen::Dynamic, _Dimension> >
+                  &points)
+  {
+    double used = tracker_.addBatch(points);
+    publish();
+    return used;
+  }
+
+  double addBatch(const _Scalar points[], int count)
+  {
+    double used = tracker_.addBatch(points, count);
+    publish();
+    return used;
+  }
+
+  /**
+   * uint64_t readSnapshot(Snapshot &out) const
+   *
+   * Any thread. Copies the newest published mean and covariance into out
+   * without locking. For a runtime dimension, construct out with
+   * Snapshot(getDimension()) so the copy does not allocate.
+   * @param out The snapshot to fill.
+   * @return The epoch of the snapshot, 0 if nothing has been published yet.
+   */
+  uint64_t readSnapshot(Snapshot &out) const;
+
+  /**
+   * uint64_t getEpoch(void) const
+   *
+   * Any thread. Lets readers skip copying when nothing new was published.
+   * @return The number of publications so far.
+   */
+  uint64_t getEpoch(void) const
+  {
+    return epoch_.load(std::memory_order_acquire);
+  }
+
+  /**
+   * int getDimension(void) const
+   *
+   * Any thread.
+   * @return The dimension of the tracker.
+   */
+  int getDimension(void) const
+  {
+    return tracker_.getDimension();
+  }
+
+  /**
+   * const Tracker& getTracker(void) const
+   *
+   * Writer thread only; the tracker is not safe to read while it is fed.
+   * @return The wrapped tracker.
+   */
+  const Tracker &getTracker(void) const
+  {
+    return tracker_;
+  }
+
+private:
+  struct Slot
+  {
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    // Odd while the writer is filling the slot.
+    std::atomic<uint64_t> sequence;
+    Snapshot snapshot;
+  };
+
+  Tracker tracker_;
+  std::atomic<uint64_t> epoch_;
+  Slot slots_[2];
+
+  /**
+   * void publish(void)
+   *
+   * Copies the tracker's current state into the slot readers are not
+   * pointed at, then points them at it.
+   */
+  void publish(void);
+};
+
+
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+ConcurrentCovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::ConcurrentCovarianceTracker(int len, typename Tracker::UpdateMode mode)
+  : ConcurrentCovarianceTracker(len, _Dimension, mode)
+{
+}
+
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+ConcurrentCovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::ConcurrentCovarianceTracker(int len, int dimension,
+                              typename Tracker::UpdateMode mode)
+  : tracker_(len, dimension, mode),
+    epoch_(0)
+{
+  for (int i = 0; i < 2; ++i) {
+    slots_[i].sequence.store(0, std::memory_order_relaxed);
+    slots_[i].snapshot = Snapshot(dimension);
+  }
+}
+
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+void ConcurrentCovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::publish(void)
+{
+  // only this thread writes epoch_, so a relaxed load is current
+  const uint64_t epoch = epoch_.load(std::memory_order_relaxed) + 1;
+  Slot &slot = slots_[epoch & 1];
+  const uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+
+  slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  slot.snapshot.epoch = epoch;
+  slot.snapshot.fraction_used = tracker_.getFractionUsed();
+  slot.snapshot.mean = tracker_.getMean();
+  slot.snapshot.covariance = tracker_.getCovariance();
+
+  slot.sequence.store(sequence + 2, std::memory_order_release);
+  epoch_.store(epoch, std::memory_order_release);
+}
+
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+uint64_t ConcurrentCovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::readSnapshot(Snapshot &out) const
+{
+  for (;;) {
+    const uint64_t epoch = epoch_.load(std::memory_order_acquire);
+    const Slot &slot = slots_[epoch & 1];
+
+    const uint64_t before = slot.sequence.load(std::memory_order_acquire);
+    if (before & 1)
+      continue;  // the writer has lapped us and is refilling this slot
+
+    out.epoch = slot.snapshot.epoch;
+    out.fraction_used = slot.snapshot.fraction_used;
+    out.mean = slot.snapshot.mean;
+    out.covariance = slot.snapshot.covariance;
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) == before)
+      return out.epoch;
+  }
+}
+
+#endif // CONCURRENTCOVARIANCETRACKER_H
@@ -0,0 +1,500 @@
+/**
+ * Low-level kernels shared by the covariance trackers, and the dispatch layer
+ * that picks a fixed-size version of each kernel for small dimensions.
+ *
+ * Every kernel is a struct template over the dimension _N with a static
+ * run(int dim, ...) function working on raw column-major double buffers, so
+ * the same code serves trackers with a compile-time dimension and trackers
+ * whose dimension is only known at runtime (_N = Eigen::Dynamic).
+ *
+ * Kernels named Packed* work on a packed symmetric matrix instead: only the
+ * upper triangle, stored column by column, so element (i, j) with i <= j is
+ * at j * (j + 1) / 2 + i. This is LAPACK's 'U' packed format.
+ *
+ * The rank-1 update behind every add and remove has hand-vectorized versions
+ * for the dimensions we use most (2, 3, 6 and 9) on x86 with GCC or Clang:
+ * an AVX2/FMA path chosen at runtime when the CPU supports it, and an SSE2
+ * path otherwise. Define COVARIANCE_KERNELS_NO_SIMD to use the portable
+ * Eigen version everywhere.
+ *
+ * @author Vanderbilt Robotics
+ * @since October 2026
+ * @brief Rank-1 update kernels and fixed-size dimension dispatch.
+ */
+
+#ifndef COVARIANCEKERNELS_H
+#define COVARIANCEKERNELS_H
+
+#include <Eigen/Dense>
+#include <cmath>
+
+#if !defined(COVARIANCE_KERNELS_NO_SIMD) && defined(__GNUC__) \
+    && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+  #define COVARIANCE_KERNELS_X86_SIMD 1
+  #include <immintrin.h>
+#endif
+
+
+namespace covariance_kernels
+{
+
+/**
+ * The largest runtime dimension routed to a fixed-size kernel by Dispatch.
+ */
+const int kMaxFixedDimension = 12;
+
+/**
+ * struct Dispatch<_Dimension>
+ *
+ * Calls _Kernel<_Dimension>::run(dim, args...). For _Dimension =
+ * Eigen::Dynamic the runtime dimension is switched on instead, so dimensions
+ * 1 to kMaxFixedDimension run the fully unrolled fixed-size kernels and only
+ * larger ones fall back to _Kernel<Eigen::Dynamic>. Example:
+ * <pre>
+ * {@code
+ * Dispatch<_Dimension>::template run<WelfordAdd>(dim, n, x, mean, co, delta);
+ * }
+ * </pre>
+ */
+template <int _Dimension>
+struct Dispatch
+{
+  template <template <int> class _Kernel, typename... _Args>
+  static void run(int dim, _Args... args)
+  {
+    _Kernel<_Dimension>::run(dim, args...);
+  }
+};
+
+template <>
+struct Dispatch<Eigen::Dynamic>
+{
+  template <template <int> class _Kernel, typename... _Args>
+  static void run(int dim, _Args... args)
+  {
+    switch (dim) {
+      case 1:  _Kernel<1>::run(dim, args...);  break;
+      case 2:  _Kernel<2>::run(dim, args...);  break;
+      case 3:  _Kernel<3>::run(dim, args...);  break;
+      case 4:  _Kernel<4>::run(dim, args...);  break;
+      case 5:  _Kernel<5>::run(dim, args...);  break;
+      case 6:  _Kernel<6>::run(dim, args...);  break;
+      case 7:  _Kernel<7>::run(dim, args...);  break;
+      case 8:  _Kernel<8>::run(dim, args...);  break;
+      case 9:  _Kernel<9>::run(dim, args...);  break;
+      case 10: _Kernel<10>::run(dim, args...); break;
+      case 11: _Kernel<11>::run(dim, args...); break;
+      case 12: _Kernel<12>::run(dim, args...); break;
+      default: _Kernel<Eigen::Dynamic>::run(dim, args...);
+    }
+  }
+};
+
+#ifdef COVARIANCE_KERNELS_X86_SIMD
+namespace simd
+{
+
+/**
+ * struct HasRankUpdate<_N>
+ *
+ * Whether rankUpdate<_N>() below has a hand-vectorized version.
+ */
+template <int _N>
+struct HasRankUpdate
+{
+  static const bool value = (_N == 2 || _N == 3 || _N == 6 || _N == 9);
+};
+
+/**
+ * bool cpuHasAvx2(void)
+ *
+ * Whether the running CPU has AVX2 and FMA. Checked once per process.
+ */
+inline bool cpuHasAvx2(void)
+{
+  static const bool has = __builtin_cpu_supports("avx2")
+                          && __builtin_cpu_supports("fma");
+  return has;
+}
+
+/**
+ * template <int _N, bool _Packed>
+ * void rankUpdateSse2(double weight, const double *delta, double *comoment)
+ *
+ * comoment += weight * delta * delta^T, two rows at a time. With _Packed,
+ * comoment is packed and only the upper triangle is updated.
+ */
+template <int _N, bool _Packed>
+inline void rankUpdateSse2(double weight, const double *delta,
+                           double *comoment)
+{
+  for (int j = 0; j < _N; ++j) {
+    const double scale = weight * delta[j];
+    const __m128d s = _mm_set1_pd(scale);
+    double *column = comoment + (_Packed ? j * (j + 1) / 2 : j * _N);
+    const int rows = (_Packed ? j + 1 : _N);
+    int i = 0;
+    for (; i + 2 <= rows; i += 2) {
+      __m128d c = _mm_loadu_pd(column + i);
+      c = _mm_add_pd(c, _mm_mul_pd(s, _mm_loadu_pd(delta + i)));
+      _mm_storeu_pd(column + i, c);
+    }
+    if (i < rows)
+      column[i] += scale * delta[i];
+  }
+}
+
+/**
+ * template <int _N, bool _Packed>
+ * void rankUpdateAvx2(double weight, const double *delta, double *comoment)
+ *
+ * comoment += weight * delta * delta^T, four rows at a time with fused
+ * multiply-adds. Only call it when cpuHasAvx2().
+ */
+template <int _N, bool _Packed>
+__attribute__((target("avx2,fma")))
+inline void rankUpdateAvx2(double weight, const double *delta,
+                           double *comoment)
+{
+  if (_N == 2 && !_Packed) {
+    // the whole 2x2 matrix is one register
+    const __m256d d = _mm256_set_pd(delta[1], delta[0], delta[1], delta[0]);
+    const __m256d s = _mm256_set_pd(weight * delta[1], weight * delta[1],
+                                    weight * delta[0], weight * delta[0]);
+    _mm256_storeu_pd(comoment,
+                     _mm256_fmadd_pd(s, d, _mm256_loadu_pd(comoment)));
+    return;
+  }
+
+  for (int j = 0; j < _N; ++j) {
+    const double scale = weight * delta[j];
+    const __m256d s = _mm256_set1_pd(scale);
+    double *column = comoment + (_Packed ? j * (j + 1) / 2 : j * _N);
+    const int rows = (_Packed ? j + 1 : _N);
+    int i = 0;
+    for (; i + 4 <= rows; i += 4) {
+      __m256d c = _mm256_loadu_pd(column + i);
+      c = _mm256_fmadd_pd(s, _mm256_loadu_pd(delta + i), c);
+      _mm256_storeu_pd(column + i, c);
+    }
+    if (i + 2 <= rows) {
+      __m128d c = _mm_loadu_pd(column + i);
+      c = _mm_fmadd_pd(_mm256_castpd256_pd128(s), _mm_loadu_pd(delta + i), c);
+      _mm_storeu_pd(column + i, c);
+      i += 2;
+    }
+    if (i < rows)
+      column[i] += scale * delta[i];
+  }
+}
+
+/**
+ * template <int _N, bool _Packed>
+ * void rankUpdate(double weight, const double *delta, double *comoment)
+ *
+ * comoment += weight * delta * delta^T on the widest instruction set the CPU
+ * supports.
+ */
+template <int _N, bool _Packed>
+inline void rankUpdate(double weight, const double *delta, double *comoment)
+{
+  if (cpuHasAvx2())
+    rankUpdateAvx2<_N, _Packed>(weight, delta, comoment);
+  else
+    rankUpdateSse2<_N, _Packed>(weight, delta, comoment);
+}
+
+} // namespace simd
+#endif
+
+/**
+ * struct RankUpdate<_N>
+ *
+ * comoment += weight * delta * delta^T, one column at a time so no temporary
+ * is created even when _N is Eigen::Dynamic. Dimensions with a
+ * hand-vectorized version use it on x86.
+ */
+template <int _N>
+struct RankUpdate
+{
+  static void run(int dim, double weight, const double *delta,
+                  double *comoment)
+  {
+#ifdef COVARIANCE_KERNELS_X86_SIMD
+    if (simd::HasRankUpdate<_N>::value) {
+      simd::rankUpdate<_N, false>(weight, delta, comoment);
+      return;
+    }
+#endif
+    Eigen::Map<const Eigen::Matrix<double, _N, 1> > d(delta, dim);
+    Eigen::Map<Eigen::Matrix<double, _N, _N> > c(comoment, dim, dim);
+    for (int j = 0; j < dim; ++j)
+      c.col(j) += (weight * d(j)) * d;
+  }
+};
+
+/**
+ * struct PackedRankUpdate<_N>
+ *
+ * RankUpdate on a packed co-moment: updates only the upper triangle, which
+ * is about half the work for larger dimensions.
+ */
+template <int _N>
+struct PackedRankUpdate
+{
+  static void run(int dim, double weight, const double *delta,
+                  double *comoment)
+  {
+#ifdef COVARIANCE_KERNELS_X86_SIMD
+    if (simd::HasRankUpdate<_N>::value) {
+      simd::rankUpdate<_N, true>(weight, delta, comoment);
+      return;
+    }
+#endif
+    const int size = (_N == Eigen::Dynamic ? dim : _N);
+    for (int j = 0; j < size; ++j) {
+      const double scale = weight * delta[j];
+      double *column = comoment + j * (j + 1) / 2;
+      for (int i = 0; i <= j; ++i)
+        column[i] += scale * delta[i];
+    }
+  }
+};
+
+/**
+ * struct BasicWelfordAdd<_N, _RankUpdate>
+ *
+ * Folds the datum x into a running mean and co-moment that summarize count
+ * data. With n = count + 1 and d = x - mean:
+ *   mean += d / n
+ *   comoment += ((n - 1) / n) * d * d^T
+ * delta is scratch space of length dim. _RankUpdate picks the storage of
+ * comoment; use the WelfordAdd and PackedWelfordAdd aliases below.
+ */
+template <int _N, template <int> class _RankUpdate>
+struct BasicWelfordAdd
+{
+  static void run(int dim, int count, const double *x, double *mean,
+                  double *comoment, double *delta)
+  {
+    Eigen::Map<const Eigen::Matrix<double, _N, 1> > xv(x, dim);
+    Eigen::Map<Eigen::Matrix<double, _N, 1> > m(mean, dim);
+    Eigen::Map<Eigen::Matrix<double, _N, 1> > d(delta, dim);
+    const double n = static_cast<double>(count) + 1.0;
+    d = xv - m;
+    m += d / n;
+    _RankUpdate<_N>::run(dim, (n - 1.0) / n, delta, comoment);
+  }
+};
+
+template <int _N>
+using WelfordAdd = BasicWelfordAdd<_N, RankUpdate>;
+
+template <int _N>
+using PackedWelfordAdd = BasicWelfordAdd<_N, PackedRankUpdate>;
+
+/**
+ * struct BasicWelfordRemove<_N, _RankUpdate>
+ *
+ * The inverse of WelfordAdd: removes the datum x from a running mean and
+ * co-moment that summarize count > 1 data. With n = count and d = x - mean:
+ *   mean -= d / (n - 1)
+ *   comoment -= (n / (n - 1)) * d * d^T
+ * delta is scratch space of length dim.
+ */
+template <int _N, template <int> class _RankUpdate>
+struct BasicWelfordRemove
+{
+  static void run(int dim, int count, const double *x, double *mean,
+                  double *comoment, double *delta)
+  {
+    Eigen::Map<const Eigen::Matrix<double, _N, 1> > xv(x, dim);
+    Eigen::Map<Eigen::Matrix<double, _N, 1> > m(mean, dim);
+    Eigen::Map<Eigen::Matrix<double, _N, 1> > d(delta, dim);
+    const double n = static_cast<double>(count);
+    d = xv - m;
+    m -= d / (n - 1.0);
+    _RankUpdate<_N>::run(dim, -n / (n - 1.0), delta, comoment);
+  }
+};
+
+template <int _N>
+using WelfordRemove = BasicWelfordRemove<_N, RankUpdate>;
+
+template <int _N>
+using PackedWelfordRemove = BasicWelfordRemove<_N, PackedRankUpdate>;
+
+/**
+ * void neumaierAdd(double &sum, double &compensation, double term)
+ *
+ * Adds term to sum and accumulates the rounding error of the addition in
+ * compensation (Neumaier's variant of Kahan summation). The pair is then
+ * renormalized, so sum alone is always the best double approximation of the
+ * total and callers can keep reading it directly.
+ */
+inline void neumaierAdd(double &sum, double &compensation, double term)
+{
+  const double total = sum + term;
+  if (std::abs(sum) >= std::abs(term))
+    compensation += (sum - total) + term;
+  else
+    compensation += (term - total) + sum;
+  sum = total + compensation;
+  compensation -= sum - total;
+}
+
+/**
+ * struct CompensatedRankUpdate<_N>
+ *
+ * RankUpdate with every element of comoment accumulated by neumaierAdd().
+ * compensation holds the running error terms and has the shape of comoment.
+ */
+template <int _N>
+struct CompensatedRankUpdate
+{
+  static void run(int dim, double weight, const double *delta,
+                  double *comoment, double *compensation)
+  {
+    // a compile-time bound lets the fixed-size versions unroll
+    const int size = (_N == Eigen::Dynamic ? dim : _N);
+    for (int j = 0; j < size; ++j) {
+      const double scale = weight * delta[j];
+      for (int i = 0; i < size; ++i)
+        neumaierAdd(comoment[j * size + i], compensation[j * size + i],
+                    scale * delta[i]);
+    }
+  }
+};
+
+/**
+ * struct PackedCompensatedRankUpdate<_N>
+ *
+ * CompensatedRankUpdate on a packed co-moment and compensation.
+ */
+template <int _N>
+struct PackedCompensatedRankUpdate
+{
+  static void run(int dim, double weight, const double *delta,
+                  double *comoment, double *compensation)
+  {
+    const int size = (_N == Eigen::Dynamic ? dim : _N);
+    int p = 0;
+    for (int j = 0; j < size; ++j) {
+      const double scale = weight * delta[j];
+      for (int i = 0; i <= j; ++i, ++p)
+        neumaierAdd(comoment[p], compensation[p], scale * delta[i]);
+    }
+  }
+};
+
+/**
+ * struct BasicCompensatedWelfordAdd<_N, _RankUpdate>
+ *
+ * WelfordAdd with the mean and co-moment accumulated by neumaierAdd(), so
+ * the rounding error of long add/remove sequences does not build up.
+ */
+template <int _N, template <int> class _RankUpdate>
+struct BasicCompensatedWelfordAdd
+{
+  static void run(int dim, int count, const double *x, double *mean,
+                  double *mean_compensation, double *comoment,
+                  double *comoment_compensation, double *delta)
+  {
+    const int size = (_N == Eigen::Dynamic ? dim : _N);
+    const double n = static_cast<double>(count) + 1.0;
+    for (int i = 0; i < size; ++i) {
+      delta[i] = x[i] - mean[i];
+      neumaierAdd(mean[i], mean_compensation[i], delta[i] / n);
+    }
+    _RankUpdate<_N>::run(dim, (n - 1.0) / n, delta, comoment,
+                         comoment_compensation);
+  }
+};
+
+template <int _N>
+using CompensatedWelfordAdd =
+  BasicCompensatedWelfordAdd<_N, CompensatedRankUpdate>;
+
+template <int _N>
+using PackedCompensatedWelfordAdd =
+  BasicCompensatedWelfordAdd<_N, PackedCompensatedRankUpdate>;
+
+/**
+ * struct BasicCompensatedWelfordRemove<_N, _RankUpdate>
+ *
+ * WelfordRemove with the mean and co-moment accumulated by neumaierAdd().
+ */
+template <int _N, template <int> class _RankUpdate>
+struct BasicCompensatedWelfordRemove
+{
+  static void run(int dim, int count, const double *x, double *mean,
+                  double *mean_compensation, double *comoment,
+                  double *comoment_compensation, double *delta)
+  {
+    const int size = (_N == Eigen::Dynamic ? dim : _N);
+    const double n = static_cast<double>(count);
+    for (int i = 0; i < size; ++i) {
+      delta[i] = x[i] - mean[i];
+      neumaierAdd(mean[i], mean_compensation[i], -delta[i] / (n - 1.0));
+    }
+    _RankUpdate<_N>::run(dim, -n / (n - 1.0), delta, comoment,
+                         comoment_compensation);
+  }
+};
+
+template <int _N>
+using CompensatedWelfordRemove =
+  BasicCompensatedWelfordRemove<_N, CompensatedRankUpdate>;
+
+template <int _N>
+using PackedCompensatedWelfordRemove =
+  BasicCompensatedWelfordRemove<_N, PackedCompensatedRankUpdate>;
+
+/**
+ * struct UnpackSymmetric<_N>
+ *
+ * full = scale * packed, filling both triangles of the column-major full.
+ */
+template <int _N>
+struct UnpackSymmetric
+{
+  static void run(int dim, double scale, const double *packed, double *full)
+  {
+    const int size = (_N == Eigen::Dynamic ? dim : _N);
+    int p = 0;
+    for (int j = 0; j < size; ++j)
+      for (int i = 0; i <= j; ++i, ++p)
+        full[j * size + i] = full[i * size + j] = scale * packed[p];
+  }
+};
+
+/**
+ * struct ExponentialUpdate<_N>
+ *
+ * Folds the datum x into an exponentially weighted mean and covariance with
+ * weight alpha (West, 1979). With d = x - mean:
+ *   mean += alpha * d
+ *   covariance = (1 - alpha) * (covariance + alpha * d * d^T)
+ * delta is scratch space of length dim.
+ */
+template <int _N>
+struct ExponentialUpdate
+{
+  static void run(int dim, double alpha, const double *x, double *mean,
+                  double *covariance, double *delta)
+  {
+    Eigen::Map<const Eigen::Matrix<double, _N, 1> > xv(x, dim);
+    Eigen::Map<Eigen::Matrix<double, _N, 1> > m(mean, dim);
+    Eigen::Map<Eigen::Matrix<double, _N, 1> > d(delta, dim);
+    Eigen::Map<Eigen::Matrix<double, _N, _N> > c(covariance, dim, dim);
+    const double keep = 1.0 - alpha;
+    d = xv - m;
+    m += alpha * d;
+    for (int j = 0; j < dim; ++j)
+      c.col(j) = keep * (c.col(j) + (alpha * d(j)) * d);
+  }
+};
+
+} // namespace covariance_kernels
+
+#endif // COVARIANCEKERNELS_H
@@ -0,0 +1,297 @@
+/**
+ * The CovarianceStatistics class. The sufficient statistics of a set of
+ * X-dimensional values (count, mean and co-moment matrix), which can be
+ * merged pairwise without revisiting the data.
+ *
+ * merge() uses the pairwise formulas of Chan, Golub and LeVeque, so it is
+ * associative and numerically stable: split a dataset into chunks, summarize
+ * each chunk on its own core with fromData(), and reduce the results in any
+ * order. CovarianceTracker::getStatistics() extracts the same summary from a
+ * tracker, so per-thread trackers can be combined at query time.
+ *
+ * @author Vanderbilt Robotics
+ * @since October 2026
+ * @brief Mergeable count, mean and co-moment of a set of values.
+ */
+
+#ifndef COVARIANCESTATISTICS_H
+#define COVARIANCESTATISTICS_H
+
+#include <Eigen/Dense>
+#include <cassert>
+
+#include "covariance-kernels.h"
+
+
+template <int _Dimension>
+class CovarianceStatistics
+{
+public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  /**
+   * Constructor. Summarizes no data.
+   */
+  CovarianceStatistics(void);
+
+  /**
+   * Constructor for statistics whose dimension is chosen at runtime, i.e.
+   * _Dimension = Eigen::Dynamic. Summarizes no data.
+   *
+   * @param dimension The number of variables in each datum.
+   */
+  explicit CovarianceStatistics(int dimension);
+
+  /**
+   * Constructor from existing sufficient statistics.
+   *
+   * @param count The number of data summarized.
+   * @param mean Their mean.
+   * @param comoment The sum of the outer products of their residuals, i.e.
+   *                 (count - 1) times their sample covariance.
+   */
+  CovarianceStatistics(int count,
+                       const Eigen::Matrix<double, _Dimension, 1> &mean,
+                       const Eigen::Matrix<double, _Dimension, _Dimension>
+                       &comoment);
+
+  /**
+   * template <typename _Derived>
+   * static CovarianceStatistics fromData(
+   *   const Eigen::MatrixBase<_Derived> &points)
+   *
+   * Summarizes a block of data with an exact two-pass computation. Example:
+   * <pre>
+   * {@code
+   * Eigen::MatrixXf chunk = ...;  // one datum per row
+   * CovarianceStatistics<Eigen::Dynamic> stats =
+   *   CovarianceStatistics<Eigen::Dynamic>::fromData(chunk);
+   * }
+   * </pre>
+   * @param points The data, one datum per row, of any scalar type.
+   * @return Their statistics.
+   */
+  template <typename _Derived>
+  static CovarianceStatistics fromData(
+    const Eigen::MatrixBase<_Derived> &points);
+
+  /**
+   * void add(const double point[])
+   *
+   * Folds one datum into the statistics (Welford).
+   * @param point The getDimension() values of the datum.
+   */
+  void add(const double point[]);
+
+  /**
+   * void remove(const double point[])
+   *
+   * Removes one datum that was previously added.
+   * @param point The getDimension() values of the datum.
+   */
+  void remove(const double point[]);
+
+  /**
+   * CovarianceStatistics& merge(const CovarianceStatistics &other)
+   *
+   * Combines other into these statistics, as if its data had been added
+   * here (Chan et al.). Associative, and commutative up to rounding.
+   * @param other The statistics to merge in. Must have the same dimension.
+   * @return *this.
+   */
+  CovarianceStatistics &merge(const CovarianceStatistics &other);
+
+  /**
+   * void clear(void)
+   *
+   * Forgets every datum.
+   */
+  void clear(void);
+
+  /**
+   * int getCount(void) const
+   *
+   * @return The number of data summarized.
+   */
+  int getCount(void) const
+  {
+    return count_;
+  }
+
+  /**
+   * int getDimension(void) const
+   *
+   * @return The number of variables in each datum.
+   */
+  int getDimension(void) const
+  {
+    return static_cast<int>(mean_.size());
+  }
+
+  /**
+   * const Eigen::Matrix<double, _Dimension, 1>& getMean(void) const
+   *
+   * @return The mean of the data; zero if there are none.
+   */
+  const Eigen::Matrix<double, _Dimension, 1> &getMean(void) const
+  {
+    return mean_;
+  }
+
+  /**
+   * const Eigen::Matrix<double, _Dimension, _Dimension>&
+   * getComoment(void) const
+   *
+   * @return The sum of the outer products of the residuals.
+   */
+  const Eigen::Matrix<double, _Dimension, _Dimension> &getComoment(void)
+    const
+  {
+    return comoment_;
+  }
+
+  /**
+   * Eigen::Matrix<double, _Dimension, _Dimension> getCovariance(void) const
+   *
+   * @return The sample covariance of the data, comoment / (count - 1), or
+   *         zeros for fewer than two data.
+   */
+  Eigen::Matrix<double, _Dimension, _Dimension> getCovariance(void) const;
+
+private:
+  int count_;
+  Eigen::Matrix<double, _Dimension, 1> mean_;
+  Eigen::Matrix<double, _Dimension, _Dimension> comoment_;
+  // Scratch for the difference between two means.
+  Eigen::Matrix<double, _Dimension, 1> delta_;
+};
+
+
+template <int _Dimension>
+CovarianceStatistics<_Dimension>::CovarianceStatistics(void)
+  : CovarianceStatistics(_Dimension)
+{
+  static_assert(_Dimension != Eigen::Dynamic,
+    "CovarianceStatistics with a runtime dimension need the dimension passed"
+    " to their constructor.");
+}
+
+template <int _Dimension>
+CovarianceStatistics<_Dimension>::CovarianceStatistics(int dimension)
+  : count_(0),
+    mean_(Eigen::Matrix<double, _Dimension, 1>::Zero(dimension)),
+    comoment_(Eigen::Matrix<double, _Dimension, _Dimension>
+              ::Zero(dimension, dimension)),
+    delta_(Eigen::Matrix<double, _Dimension, 1>::Zero(dimension))
+{
+  assert(_Dimension == Eigen::Dynamic || dimension == _Dimension);
+}
+
+template <int _Dimension>
+CovarianceStatistics<_Dimension>
+::CovarianceStatistics(int count,
+                       const Eigen::Matrix<double, _Dimension, 1> &mean,
+                       const Eigen::Matrix<double, _Dimension, _Dimension>
+                       &comoment)
+  : count_(count),
+    mean_(mean),
+    comoment_(comoment),
+    delta_(Eigen::Matrix<double, _Dimension, 1>::Zero(mean.size()))
+{
+  assert(count >= 0);
+}
+
+template <int _Dimension>
+template <typename _Derived>
+CovarianceStatistics<_Dimension> CovarianceStatistics<_Dimension>
+::fromData(const Eigen::MatrixBase<_Derived> &points)
+{
+  const int count = static_cast<int>(points.rows());
+  CovarianceStatistics stats(static_cast<int>(points.cols()));
+  if (count == 0)
+    return stats;
+
+  stats.count_ = count;
+  stats.mean_ = points.template cast<double>().colwise().sum().transpose()
+                / static_cast<double>(count);
+  Eigen::Matrix<double, Eigen::Dynamic, _Dimension> residuals =
+    points.template cast<double>().rowwise() - stats.mean_.transpose();
+  stats.comoment_.noalias() = residuals.transpose() * residuals;
+  return stats;
+}
+
+template <int _Dimension>
+void CovarianceStatistics<_Dimension>::add(const double point[])
+{
+  covariance_kernels::Dispatch<_Dimension>::template
+    run<covariance_kernels::WelfordAdd>(getDimension(), count_, point,
+                                        mean_.data(), comoment_.data(),
+                                        delta_.data());
+  ++count_;
+}
+
+template <int _Dimension>
+void CovarianceStatistics<_Dimension>::remove(const double point[])
+{
+  assert(count_ > 0);
+  if (count_ == 1) {
+    clear();
+    return;
+  }
+
+  covariance_kernels::Dispatch<_Dimension>::template
+    run<covariance_kernels::WelfordRemove>(getDimension(), count_, point,
+                                           mean_.data(), comoment_.data(),
+                                           delta_.data());
+  --count_;
+}
+
+template <int _Dimension>
+CovarianceStatistics<_Dimension> &CovarianceStatistics<_Dimension>
+::merge(const CovarianceStatistics &other)
+{
+  assert(other.getDimension() == getDimension());
+  if (other.count_ == 0)
+    return *this;
+  if (count_ == 0) {
+    count_ = other.count_;
+    mean_ = other.mean_;
+    comoment_ = other.comoment_;
+    return *this;
+  }
+
+  // with d = other.mean - mean and n = count + other.count:
+  //  mean += (other.count / n) * d
+  //  comoment += other.comoment + (count * other.count / n) * d * d^T
+  const double n_a = static_cast<double>(count_);
+  const double n_b = static_cast<double>(other.count_);
+  const double n = n_a + n_b;
+  delta_ = other.mean_ - mean_;
+  mean_ += (n_b / n) * delta_;
+  comoment_ += other.comoment_;
+  covariance_kernels::Dispatch<_Dimension>::template
+    run<covariance_kernels::RankUpdate>(getDimension(), n_a * n_b / n,
+                                        delta_.data(), comoment_.data());
+  count_ += other.count_;
+  return *this;
+}
+
+template <int _Dimension>
+void CovarianceStatistics<_Dimension>::clear(void)
+{
+  count_ = 0;
+  mean_.setZero();
+  comoment_.setZero();
+}
+
+template <int _Dimension>
+Eigen::Matrix<double, _Dimension, _Dimension>
+CovarianceStatistics<_Dimension>::getCovariance(void) const
+{
+  if (count_ < 2)
+    return Eigen::Matrix<double, _Dimension, _Dimension>
+           ::Zero(getDimension(), getDimension());
+  return comoment_ / (static_cast<double>(count_) - 1.0);
+}
+
+#endif // COVARIANCESTATISTICS_H
@@ -0,0 +1,371 @@
+/**
+ * The CovarianceTrackerBank class. Many same-shaped windowed covariance
+ * trackers (one per wheel, joint or IMU, say) that all receive one datum per
+ * frame, stored together in a structure-of-arrays layout.
+ *
+ * Every quantity is stored lane-interleaved: value k of tracker t lives at
+ * [k * stride + t]. The windows (in _Scalar, so a float bank stores half as
+ * much) and the double means and packed upper-triangular
+ * co-moments of all trackers therefore sit in a few contiguous arrays, and
+ * addFrame() updates every tracker at once with SIMD lanes running across
+ * trackers (4 doubles per AVX2 register when the CPU has AVX2 and FMA,
+ * detected at runtime as in covariance-kernels.h, and whatever the compiler
+ * targets otherwise). Each tracker behaves like a CovarianceTracker in
+ * INCREMENTAL mode.
+ *
+ * @author Vanderbilt Robotics
+ * @since October 2026
+ * @brief Update thousands of small covariance trackers per frame.
+ */
+
+#ifndef COVARIANCETRACKERBANK_H
+#define COVARIANCETRACKERBANK_H
+
+#if __cplusplus <= 199711L
+  #error This library needs at least C++11! Compile with -std=c++11 or gnu++11.
+#endif
+
+#include <Eigen/Dense>
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+#include "covariance-kernels.h"
+
+
+template <typename _Scalar, int _Dimension>
+class CovarianceTrackerBank
+{
+  static_assert(_Dimension != Eigen::Dynamic,
+    "CovarianceTrackerBank needs a compile-time dimension.");
+
+  // The number of entries in a packed upper triangle.
+  static const int kPacked = _Dimension * (_Dimension + 1) / 2;
+  // Lanes are padded to a multiple of this so the SIMD loops need no tails.
+  static const int kLaneMultiple = 4;
+
+public:
+  /**
+   * Constructor. Every tracker starts empty.
+   *
+   * @param trackers The number of trackers in the bank.
+   * @param len The number of stored data in each tracker's window. Defaults
+   *            to 100.
+   */
+  CovarianceTrackerBank(int trackers, int len = 100);
+
+  /**
+   * double addFrame(const Eigen::Ref<const Eigen::Matrix<_Scalar,
+   *                 _Dimension, Eigen::Dynamic>, 0,
+   *                 Eigen::OuterStride<_Dimension> > &frame)
+   *
+   * Adds one datum to every tracker. A block whose columns are not packed,
+   * such as big.topRows(3), is copied into a packed temporary first.
+   * @param frame The data, column t going to tracker t.
+   * @return The fraction of each window that is used.
+   */
+  double addFrame(const Eigen::Ref<
+                  const Eigen::Matrix<_Scalar, _Dimension, Eigen::Dynamic>, 0,
+                  Eigen::OuterStride<_Dimension> > &frame);
+
+  /**
+   * double addFrame(const _Scalar frame[])
+   *
+   * Adds one datum to every tracker. frame holds getTrackerCount() data back
+   * to back, tracker t's at frame[t * _Dimension].
+   * @param frame The data.
+   * @return The fraction of each window that is used.
+   */
+  double addFrame(const _Scalar frame[]);
+
+  /**
+   * void getCovariances(double out[]) const
+   *
+   * Exports every tracker's covariance matrix in one pass. Tracker t's
+   * column-major _Dimension x _Dimension matrix starts at
+   * out[t * _Dimension * _Dimension]. Zeros until two frames were added.
+   * @param out A buffer of getTrackerCount() * _Dimension^2 doubles.
+   */
+  void getCovariances(double out[]) const;
+
+  /**
+   * void getMeans(double out[]) const
+   *
+   * Exports every tracker's mean; tracker t's starts at out[t * _Dimension].
+   * @param out A buffer of getTrackerCount() * _Dimension doubles.
+   */
+  void getMeans(double out[]) const;
+
+  /**
+   * Eigen::Matrix<double, _Dimension, _Dimension> getCovariance(int tracker)
+   *
+   * @param tracker The index of the tracker.
+   * @return Its covariance matrix.
+   */
+  Eigen::Matrix<double, _Dimension, _Dimension> getCovariance(int tracker)
+    const;
+
+  /**
+   * Eigen::Matrix<double, _Dimension, 1> getMean(int tracker)
+   *
+   * @param tracker The index of the tracker.
+   * @return Its mean vector.
+   */
+  Eigen::Matrix<double, _Dimension, 1> getMean(int tracker) const;
+
+  /**
+   * int getTrackerCount(void)
+   *
+   * @return The number of trackers in the bank.
+   */
+  int getTrackerCount(void) const
+  {
+    return trackers_;
+  }
+
+  /**
+   * int getDataLength(void)
+   *
+   * @return The number of data that can be stored in each tracker.
+   */
+  int getDataLength(void) const
+  {
+    return data_length_;
+  }
+
+  /**
+   * int getDimension(void)
+   *
+   * @return _Dimension.
+   */
+  int getDimension(void) const
+  {
+    return _Dimension;
+  }
+
+  /**
+   * double getFractionUsed(void)
+   *
+   * @return The fraction of each window that is used. (>= 0 and <= 1)
+   */
+  double getFractionUsed(void) const
+  {
+    return (static_cast<double>(num_used_data_)
+      / static_cast<double>(data_length_));
+  }
+
+private:
+  const int trackers_;
+  const int stride_;  // trackers_ rounded up to kLaneMultiple.
+  const int data_length_;
+  int newest_data_;  // The frame index of the newest datum.
+  int num_used_data_;  // The number of data in every window.
+  // data_length_ frames, each _Dimension rows of stride_ lanes.
+  std::vector<_Scalar> window_;
+  std::vector<double> mean_;  // _Dimension rows of stride_ lanes.
+  // kPacked rows of stride_ lanes; the upper triangle column by column.
+  std::vector<double> comoment_;
+  std::vector<double> delta_;  // Scratch, _Dimension rows of stride_ lanes.
+
+  /**
+   * void updateLanes(const _Scalar frame[], double mean_scale,
+   *                  double weight)
+   *
+   * For every lane, with d = x - mean: mean += mean_scale * d and
+   * comoment += weight * d * d^T. Both Welford's add and remove have this
+   * form, with the scales depending only on the shared count.
+   * @param frame One frame of the window, _Dimension rows of stride_ lanes.
+   */
+  void updateLanes(const _Scalar frame[], double mean_scale, double weight);
+
+  /**
+   * static void scaledProductAdd(double c[], const double a[],
+   *                              const double b[], double weight, int len)
+   *
+   * c[k] += weight * a[k] * b[k] for k < len, a multiple of kLaneMultiple.
+   */
+  static void scaledProductAdd(double c[], const double a[], const double b[],
+                               double weight, int len);
+
+#ifdef COVARIANCE_KERNELS_X86_SIMD
+  /**
+   * static void scaledProductAddAvx2(double c[], const double a[],
+   *                                  const double b[], double weight, int len)
+   *
+   * scaledProductAdd() four lanes at a time with fused multiply-adds. Only
+   * call it when covariance_kernels::simd::cpuHasAvx2().
+   */
+  __attribute__((target("avx2,fma")))
+  static void scaledProductAddAvx2(double c[], const double a[],
+                                   const double b[], double weight, int len);
+#endif
+};
+
+
+template <typename _Scalar, int _Dimension>
+CovarianceTrackerBank<_Scalar, _Dimension>
+::CovarianceTrackerBank(int trackers, int len)
+  : trackers_(trackers),
+    stride_((trackers + kLaneMultiple - 1) / kLaneMultiple * kLaneMultiple),
+    data_length_(len),
+    newest_data_(-1),
+    num_used_data_(0),
+    window_(static_cast<size_t>(len) * _Dimension * stride_, _Scalar(0)),
+    mean_(_Dimension * stride_, 0.0),
+    comoment_(kPacked * stride_, 0.0),
+    delta_(_Dimension * stride_, 0.0)
+{
+  assert(trackers > 0 && len > 0);
+}
+
+template <typename _Scalar, int _Dimension>
+double CovarianceTrackerBank<_Scalar, _Dimension>
+::addFrame(const Eigen::Ref<
+           const Eigen::Matrix<_Scalar, _Dimension, Eigen::Dynamic>, 0,
+           Eigen::OuterStride<_Dimension> > &frame)
+{
+  assert(frame.cols() == trackers_);
+  // the outer stride is pinned to _Dimension, so the columns are contiguous
+  return addFrame(frame.data());
+}
+
+template <typename _Scalar, int _Dimension>
+double CovarianceTrackerBank<_Scalar, _Dimension>
+::addFrame(const _Scalar frame[])
+{
+  newest_data_ = (newest_data_ + 1) % data_length_;
+  _Scalar *slot = &window_[static_cast<size_t>(newest_data_) * _Dimension
+                           * stride_];
+
+  // the frame about to be overwritten leaves every tracker at once
+  if (num_used_data_ == data_length_) {
+    if (num_used_data_ == 1) {
+      std::fill(mean_.begin(), mean_.end(), 0.0);
+      std::fill(comoment_.begin(), comoment_.end(), 0.0);
+    } else {
+      const double n = static_cast<double>(num_used_data_);
+      updateLanes(slot, -1.0 / (n - 1.0), -n / (n - 1.0));
+    }
+    --num_used_data_;
+  }
+
+  // transpose the tracker-major input into the lane-major window
+  for (int t = 0; t < trackers_; ++t)
+    for (int i = 0; i < _Dimension; ++i)
+      slot[i * stride_ + t] = frame[t * _Dimension + i];
+
+  ++num_used_data_;
+  const double n = static_cast<double>(num_used_data_);
+  updateLanes(slot, 1.0 / n, (n - 1.0) / n);
+
+  return getFractionUsed();
+}
+
+template <typename _Scalar, int _Dimension>
+void CovarianceTrackerBank<_Scalar, _Dimension>
+::updateLanes(const _Scalar frame[], double mean_scale, double weight)
+{
+  for (int i = 0; i < _Dimension; ++i) {
+    const _Scalar *x = frame + i * stride_;
+    double *m = &mean_[i * stride_];
+    double *d = &delta_[i * stride_];
+    for (int t = 0; t < stride_; ++t) {
+      d[t] = static_cast<double>(x[t]) - m[t];
+      m[t] += mean_scale * d[t];
+    }
+  }
+
+  int p = 0;
+  for (int j = 0; j < _Dimension; ++j)
+    for (int i = 0; i <= j; ++i, ++p)
+      scaledProductAdd(&comoment_[p * stride_], &delta_[i * stride_],
+                       &delta_[j * stride_], weight, stride_);
+}
+
+template <typename _Scalar, int _Dimension>
+void CovarianceTrackerBank<_Scalar, _Dimension>
+::scaledProductAdd(double c[], const double a[], const double b[],
+                   double weight, int len)
+{
+#ifdef COVARIANCE_KERNELS_X86_SIMD
+  if (covariance_kernels::simd::cpuHasAvx2()) {
+    scaledProductAddAvx2(c, a, b, weight, len);
+    return;
+  }
+#endif
+  // simple enough for the compiler to vectorize with whatever it targets
+  for (int k = 0; k < len; ++k)
+    c[k] += weight * a[k] * b[k];
+}
+
+#ifdef COVARIANCE_KERNELS_X86_SIMD
+template <typename _Scalar, int _Dimension>
+__attribute__((target("avx2,fma")))
+void CovarianceTrackerBank<_Scalar, _Dimension>
+::scaledProductAddAvx2(double c[], const double a[], const double b[],
+                       double weight, int len)
+{
+  const __m256d w = _mm256_set1_pd(weight);
+  for (int k = 0; k < len; k += 4) {
+    __m256d ab = _mm256_mul_pd(_mm256_loadu_pd(a + k), _mm256_loadu_pd(b + k));
+    _mm256_storeu_pd(c + k, _mm256_fmadd_pd(w, ab, _mm256_loadu_pd(c + k)));
+  }
+}
+#endif
+
+template <typename _Scalar, int _Dimension>
+void CovarianceTrackerBank<_Scalar, _Dimension>
+::getCovariances(double out[]) const
+{
+  const double scale = (num_used_data_ > 1)
+                       ? 1.0 / (static_cast<double>(num_used_data_) - 1.0)
+                       : 0.0;
+  int p = 0;
+  for (int j = 0; j < _Dimension; ++j) {
+    for (int i = 0; i <= j; ++i, ++p) {
+      const double *c = &comoment_[p * stride_];
+      for (int t = 0; t < trackers_; ++t) {
+        double *matrix = out + t * _Dimension * _Dimension;
+        matrix[j * _Dimension + i] = matrix[i * _Dimension + j] = c[t] * scale;
+      }
+    }
+  }
+}
+
+template <typename _Scalar, int _Dimension>
+void CovarianceTrackerBank<_Scalar, _Dimension>::getMeans(double out[]) const
+{
+  for (int i = 0; i < _Dimension; ++i)
+    for (int t = 0; t < trackers_; ++t)
+      out[t * _Dimension + i] = mean_[i * stride_ + t];
+}
+
+template <typename _Scalar, int _Dimension>
+Eigen::Matrix<double, _Dimension, _Dimension>
+CovarianceTrackerBank<_Scalar, _Dimension>::getCovariance(int tracker) const
+{
+  assert(tracker >= 0 && tracker < trackers_);
+  const double scale = (num_used_data_ > 1)
+                       ? 1.0 / (static_cast<double>(num_used_data_) - 1.0)
+                       : 0.0;
+  Eigen::Matrix<double, _Dimension, _Dimension> covariance;
+  int p = 0;
+  for (int j = 0; j < _Dimension; ++j)
+    for (int i = 0; i <= j; ++i, ++p)
+      covariance(i, j) = covariance(j, i) =
+        comoment_[p * stride_ + tracker] * scale;
+  return covariance;
+}
+
+template <typename _Scalar, int _Dimension>
+Eigen::Matrix<double, _Dimension, 1>
+CovarianceTrackerBank<_Scalar, _Dimension>::getMean(int tracker) const
+{
+  assert(tracker >= 0 && tracker < trackers_);
+  Eigen::Matrix<double, _Dimension, 1> mean;
+  for (int i = 0; i < _Dimension; ++i)
+    mean(i) = mean_[i * stride_ + tracker];
+  return mean;
+}
+
+#endif // COVARIANCETRACKERBANK_H
@@ -20,24 +20,102 @@
 #endif
 
 #include <Eigen/Dense>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
 #include <vector>
 
+#include "covariance-kernels.h"
+#include "covariance-statistics.h"
 
-template <typename _Scalar, int _Dimension>
+
+/**
+ * _Scalar is the type of the data passed in. _Storage is the type the window
+ * keeps them in; it defaults to double, but passing _Storage = _Scalar (e.g.
+ * float, or int16_t for raw sensor counts) shrinks the window by 2-4x and 
+ * saves the conversion on insertion. Only the window uses _Storage: the 
+ * mean, the co-moment and every accumulation are always done in double, so 
+ * _Storage only needs to hold the input values exactly. RECOMPUTE mode also
+ * keeps a double residual per value, so the savings are smaller there.
+ *
+ * _Layout is the memory order of the window, Eigen::ColMajor or 
+ * Eigen::RowMajor. ColMajor keeps each variable contiguous, so insertion 
+ * writes _Dimension values each data length apart, i.e. one cache line per 
+ * variable. RowMajor keeps each datum contiguous, so insertion and eviction 
+ * touch a single cache line, and the RECOMPUTE covariance is summed over
+ * whole rows. Prefer it in INCREMENTAL mode, and in RECOMPUTE mode from about
+ * a dozen variables up; for a few variables ColMajor recomputes long windows
+ * faster. examples/layout-benchmark.cpp measures the crossover.
+ */
+template <typename _Scalar, int _Dimension, typename _Storage = double,
+          int _Layout = Eigen::ColMajor>
 class CovarianceTracker
 {
+  // Eigen rejects row-major single-column matrices; both layouts are the 
+  //  same thing in that case anyway
+  static const int kWindowOptions = 
+    (_Dimension == 1 ? Eigen::ColMajor : _Layout) | Eigen::AutoAlign;
+  // The largest fixed dimension whose row-major Gram matrix is summed as
+  //  unrolled outer products rather than with a rank-k update.
+  static const int kMaxUnrolledGram = 16;
+  // The length of a packed upper triangle; see covariance-kernels.h.
+  static const int kPackedSize = (_Dimension == Eigen::Dynamic 
+    ? Eigen::Dynamic : _Dimension * (_Dimension + 1) / 2);
+  typedef Eigen::Matrix<double, kPackedSize, 1> PackedMatrix;
+
 public:
+  /**
+   * How the tracker keeps its statistics current.
+   *
+   * RECOMPUTE recalculates the mean and covariance from the whole stored 
+   * window on the first query after new data arrives, which costs 
+   * O(len * _Dimension^2) per query.
+   *
+   * INCREMENTAL keeps a running count, mean and co-moment matrix, and folds 
+   * each inserted and evicted datum into them inside addData(). Every update
+   * then costs O(_Dimension^2) no matter how long the window is, and queries
+   * are only a scale of the co-moment.
+   */
+  enum UpdateMode
+  {
+    RECOMPUTE,
+    INCREMENTAL
+  };
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
   /**
    * Constructor. The covariance values are set to 0. Data length is set to 100.
    *
    * @param len The number of stored data in this windowed tracker. Defaults
    *            to 100.
+   * @param mode How the statistics are kept current. Defaults to RECOMPUTE.
+   */
+  CovarianceTracker(int len = 100, UpdateMode mode = RECOMPUTE);
+
+  /**
+   * Constructor for a tracker whose dimension is chosen at runtime, i.e. 
+   * _Dimension = Eigen::Dynamic. Example:
+   * <pre>
+   * {@code
+   * CovarianceTracker<float, Eigen::Dynamic> covtrack(100, num_channels);
+   * }
+   * </pre>
+   * Dimensions 1 through 12 run the same fixed-size update kernels as the 
+   * equivalent compile-time tracker. May also be used with a fixed 
+   * _Dimension, in which case dimension must equal _Dimension.
+   *
+   * @param len The number of stored data in this windowed tracker.
+   * @param dimension The number of variables in each datum.
+   * @param mode How the statistics are kept current. Defaults to RECOMPUTE.
    */
-  CovarianceTracker(int len = 100);
+  CovarianceTracker(int len, int dimension, UpdateMode mode = RECOMPUTE);
 
   ~CovarianceTracker() = default;
 
-  CovarianceTracker(const CovarianceTracker<_Scalar, _Dimension>&) = default;
+  CovarianceTracker(const CovarianceTracker&) = default;
 
   /**
    * double addData(Eigen::Matrix<_Scalar, _Dimension, 1> point)
@@ -53,7 +131,7 @@ public:
    * </pre>
    * 
    * @param point The vector data point to add. Note this _must_ be a vector of
-   *              identical length to _Dimension.
+   *              identical length to getDimension().
    * @return The fraction of the stored data matrix that is used. 
    */
   double addData(const Eigen::Matrix<_Scalar, _Dimension, 1> &point);
@@ -85,8 +163,8 @@ public:
    * double addData(const std::vector<_Scalar> point)
    *
    * Adds the specified data point to this tracker. Asserts the size of point
-   * is equal to _Dimension! So only pass the correct number of arguments or
-   * you will get a runtime error. 
+   * is equal to getDimension()! So only pass the correct number of arguments
+   * or you will get a runtime error. 
    * @param point The std::vector<_Scalar> containing the data
    * @return The fraction of the stored data matrix that is used.
    */
@@ -96,13 +174,109 @@ public:
    * double addData(const _Scalar[] point)
    *
    * Receives a _Scalar array to be used as a data point. If the input array 
-   * does not have a length _Dimension, memory will be grabbed that does not
-   * belong to the array, which will lead to undefined behavior. 
+   * does not have a length getDimension(), memory will be grabbed that does 
+   * not belong to the array, which will lead to undefined behavior. 
    * @param point The _Scalar array that contains the data point to add.
    * @return The fraction of the stored data matrix that is used.
    */
   double addData(const _Scalar point[]);
 
+  /**
+   * double addDataGated(const _Scalar point[], double threshold)
+   *
+   * Scores point against the current mean and covariance, and only adds it
+   * if its squared Mahalanobis distance is at most threshold, so spikes 
+   * from sensor glitches do not poison the window. Scoring reuses the 
+   * maintained inverse (see setPrecisionTracking()) or Cholesky factor (see
+   * setCholeskyTracking()), so with tracking on it costs O(_Dimension^2). 
+   * A handful of data give too poor an estimate to gate against, so every 
+   * point is scored but added until the window is full. Example:
+   * <pre>
+   * {@code
+   * // 3 degrees of freedom, 99.9% of inliers have a squared distance 
+   * //  below 16.27
+   * if (covtrack.addDataGated(sample, 16.27) > 16.27)
+   *   ROS_WARN("rejected an outlier");
+   * }
+   * </pre>
+   * @param point The getDimension() values of the datum.
+   * @param threshold The largest accepted squared Mahalanobis distance, 
+   *                  e.g. a chi-squared quantile with getDimension() 
+   *                  degrees of freedom.
+   * @return The squared Mahalanobis distance of point (0 if the covariance
+   *         is not positive definite). Once the window is full, point was 
+   *         rejected iff this exceeds threshold.
+   */
+  double addDataGated(const _Scalar point[], double threshold);
+
+  /**
+   * double addDataGated(const Eigen::Matrix<_Scalar, _Dimension, 1> &point,
+   *                     double threshold)
+   *
+   * See addDataGated() above.
+   */
+  double addDataGated(const Eigen::Matrix<_Scalar, _Dimension, 1> &point,
+                      double threshold)
+  {
+    assert(point.size() == dimension_);
+    return addDataGated(point.data(), threshold);
+  }
+
+  /**
+   * uint64_t getRejectionCount(void) const
+   *
+   * @return The number of data addDataGated() has rejected.
+   */
+  uint64_t getRejectionCount(void) const
+  {
+    return rejections_;
+  }
+
+  /**
+   * void resetRejectionCount(void)
+   *
+   * Sets getRejectionCount() back to 0.
+   */
+  void resetRejectionCount(void)
+  {
+    rejections_ = 0;
+  }
+
+  /**
+   * double addBatch(const Eigen::Ref<const Eigen::Matrix<_Scalar, 
+   *                 Eigen::Dynamic, _Dimension> > &points)
+   *
+   * Adds every row of points to this tracker, oldest first, as if addData()
+   * were called once per row. The rows are copied into the window with at 
+   * most two block copies, and in INCREMENTAL mode the evicted data and the
+   * new batch are each folded into the statistics as one rank-k update.
+   * Example:
+   * <pre>
+   * {@code
+   * CovarianceTracker<float, 3> covtrack(100);
+   * Eigen::Matrix<float, Eigen::Dynamic, 3> fifo(32, 3);  // 32 samples
+   * covtrack.addBatch(fifo);
+   * }
+   * </pre>
+   * @param points The data to add, one datum per row.
+   * @return The fraction of the stored data matrix that is used.
+   */
+  double addBatch(const Eigen::Ref<
+                  const Eigen::Matrix<_Scalar, Eigen::Dynamic, _Dimension> > 
+                  &points);
+
+  /**
+   * double addBatch(const _Scalar points[], int count)
+   *
+   * Adds count data stored back to back in points, i.e. datum i occupies 
+   * points[i * getDimension()] through points[(i + 1) * getDimension() - 1].
+   * This is the layout of an interleaved sensor FIFO. See addBatch() above.
+   * @param points The _Scalar array that contains the data to add.
+   * @param count The number of data in points.
+   * @return The fraction of the stored data matrix that is used.
+   */
+  double addBatch(const _Scalar points[], int count);
+
   /**
    * int getDataLength(void)
    *
@@ -114,30 +288,202 @@ public:
   }
 
   /**
-   * Eigen::Matrix<>& getCovariance(void)
+   * void resize(int len)
+   *
+   * Changes getDataLength() in place, keeping the most recent 
+   * min(getDataLength(), len) data in chronological order. In INCREMENTAL 
+   * mode the data that no longer fit leave the running statistics as one 
+   * block downdate. Shrinking keeps the existing buffers, so growing back up
+   * to the largest length used so far does not allocate either.
+   * @param len The new number of stored data. Must be positive.
+   */
+  void resize(int len);
+
+  /**
+   * const Eigen::Matrix<>& getCovariance(void) const
    * 
    * Calculate the covariance matrix. If no data has been inserted into this tracker,
-   * returns a _Dimension x _Dimension matrix of zeros. 
+   * returns a _Dimension x _Dimension matrix of zeros. The result is cached 
+   * until the data change, and the reference stays valid for the lifetime of 
+   * the tracker, so repeated queries neither recompute nor copy.
    * @return The current calculated covariance matrix. 
    */
-  Eigen::Matrix<double, _Dimension, _Dimension> getCovariance(void);
+  const Eigen::Matrix<double, _Dimension, _Dimension> &getCovariance(void) 
+    const;
+
+  /**
+   * void getCovarianceInto(double *out, int order = Eigen::RowMajor) const
+   *
+   * Writes the covariance matrix straight into a caller-owned buffer of 
+   * getDimension()^2 doubles, e.g. the covariance array of a sensor message:
+   * <pre>
+   * {@code
+   * covtrack.getCovarianceInto(imu_msg.linear_acceleration_covariance.data());
+   * }
+   * </pre>
+   * @param out The buffer to write to.
+   * @param order Eigen::RowMajor or Eigen::ColMajor. Both give the same 
+   *              values for a symmetric matrix, but the order is honored 
+   *              for callers that rely on it.
+   */
+  void getCovarianceInto(double *out, int order = Eigen::RowMajor) const;
+
+  /**
+   * void getCovariancePacked(double *out) const
+   *
+   * Writes the upper triangle of the covariance matrix, column by column, 
+   * into a caller-owned buffer of getDimension() * (getDimension() + 1) / 2 
+   * doubles; element (i, j) with i <= j goes to out[j * (j + 1) / 2 + i]. 
+   * This is LAPACK's 'U' packed format (e.g. dspmv, dpptrf). In INCREMENTAL 
+   * mode it is copied straight from the packed running co-moment without 
+   * expanding the full matrix.
+   * @param out The buffer to write to.
+   */
+  void getCovariancePacked(double *out) const;
 
   /**
    * int getDimension(void)
    *
-   * @return The dimension of this covariance tracker.
+   * @return The dimension of this covariance tracker. Equal to _Dimension 
+   *         unless _Dimension is Eigen::Dynamic.
    */
   int getDimension(void) const
   {
-    return _Dimension;
+    return dimension_;
   }
 
   /**
-   * Eigen::Matrix<double, _Dimension, 1> getMean(void)
+   * const Eigen::Matrix<double, _Dimension, 1>& getMean(void) const
    *
    * @return The mean vector of the values stored in this covariance tracker.
+   *         Cached like getCovariance().
+   */
+  const Eigen::Matrix<double, _Dimension, 1> &getMean(void) const;
+
+  /**
+   * void getMeanInto(double *out) const
+   *
+   * Writes the mean vector into a caller-owned buffer of getDimension() 
+   * doubles.
+   * @param out The buffer to write to.
+   */
+  void getMeanInto(double *out) const;
+
+  /**
+   * const Eigen::Matrix<double, _Dimension, 1>& getStdDev(void) const
+   *
+   * @return The standard deviation of each variable, the square root of the
+   *         diagonal of getCovariance(). Cached like getCovariance().
+   */
+  const Eigen::Matrix<double, _Dimension, 1> &getStdDev(void) const;
+
+  /**
+   * const Eigen::Matrix<double, _Dimension, _Dimension>& 
+   * getCorrelation(void) const
+   *
+   * @return The correlation matrix, getCovariance() with entry (i, j) 
+   *         divided by getStdDev()(i) * getStdDev()(j). Entries involving a
+   *         variable with zero variance are 0, except the unit diagonal. 
+   *         Computed in the same pass as getStdDev() and cached with it.
+   */
+  const Eigen::Matrix<double, _Dimension, _Dimension> &getCorrelation(void) 
+    const;
+
+  /**
+   * void getStdDevInto(double *out) const
+   *
+   * Writes getStdDev() into a caller-owned buffer of getDimension() doubles.
+   * @param out The buffer to write to.
+   */
+  void getStdDevInto(double *out) const;
+
+  /**
+   * void getCorrelationInto(double *out, int order = Eigen::RowMajor) const
+   *
+   * Writes getCorrelation() into a caller-owned buffer of getDimension()^2
+   * doubles, like getCovarianceInto().
+   * @param out The buffer to write to.
+   * @param order Eigen::RowMajor or Eigen::ColMajor.
+   */
+  void getCorrelationInto(double *out, int order = Eigen::RowMajor) const;
+
+  /**
+   * const Eigen::Matrix<double, _Dimension, _Dimension>& 
+   * getPrincipalAxes(void) const
+   *
+   * The eigenvectors of the covariance, e.g. the axes of an uncertainty 
+   * ellipse. Instead of solving from scratch, each refresh rotates the 
+   * covariance into the previous eigenvectors, where a small change of the 
+   * window leaves it nearly diagonal, and finishes with cyclic Jacobi 
+   * sweeps; see getLastSweepCount(). Cached like getCovariance().
+   * @return The unit eigenvectors as columns, in the order of 
+   *         getPrincipalVariances().
+   */
+  const Eigen::Matrix<double, _Dimension, _Dimension> &
+  getPrincipalAxes(void) const;
+
+  /**
+   * const Eigen::Matrix<double, _Dimension, 1>& 
+   * getPrincipalVariances(void) const
+   *
+   * @return The eigenvalues of the covariance, i.e. the variance along each
+   *         principal axis, in increasing order.
+   */
+  const Eigen::Matrix<double, _Dimension, 1> &getPrincipalVariances(void) 
+    const;
+
+  /**
+   * void setEigenTolerance(double tolerance)
+   *
+   * Sets when the Jacobi sweeps behind getPrincipalAxes() stop: once the 
+   * off-diagonal part of the rotated covariance is at most tolerance times
+   * its Frobenius norm. Defaults to 1e-12.
+   * @param tolerance The relative tolerance, > 0.
+   */
+  void setEigenTolerance(double tolerance)
+  {
+    assert(tolerance > 0.0);
+    eigen_tolerance_ = tolerance;
+    update_axes_ = true;
+  }
+
+  /**
+   * double getEigenTolerance(void) const
+   *
+   * @return The relative tolerance of the Jacobi sweeps.
+   */
+  double getEigenTolerance(void) const
+  {
+    return eigen_tolerance_;
+  }
+
+  /**
+   * int getLastSweepCount(void) const
+   *
+   * @return The number of Jacobi sweeps the last refresh of 
+   *         getPrincipalAxes() needed; 0 if the previous axes were still 
+   *         within tolerance.
+   */
+  int getLastSweepCount(void) const
+  {
+    return last_sweeps_;
+  }
+
+  /**
+   * CovarianceStatistics<_Dimension> getStatistics(void) const
+   *
+   * Summarizes the data in the window as mergeable sufficient statistics,
+   * e.g. to combine per-thread trackers at query time:
+   * <pre>
+   * {@code
+   * Eigen::Matrix3d cov = tracker_a.getStatistics()
+   *                       .merge(tracker_b.getStatistics())
+   *                       .getCovariance();
+   * }
+   * </pre>
+   * @return The count, mean and co-moment of the stored data.
    */
-  Eigen::Matrix<double, _Dimension, 1> getMean(void);
+  CovarianceStatistics<_Dimension> getStatistics(void) const;
 
   /* 
    * double getFractionUsed(void)
@@ -150,134 +496,566 @@ public:
       / static_cast<double>(data_length_));
   }
 
-private:
-  bool update_mean_, update_cov_, update_residuals_;
-  int newest_data_;  // The pointer to the newest value inserted.
-  int num_used_data_;  // The number of data used.
-  Eigen::Matrix<double, _Dimension, 1> mean_;
-  const int data_length_;
-  Eigen::Matrix<double, Eigen::Dynamic, _Dimension> data_double_;
-  Eigen::Matrix<double, Eigen::Dynamic, _Dimension> residuals_;
-  Eigen::Matrix<double, _Dimension, _Dimension> covariance_;
-  // The column matrices for each dimension; i.e. columns_[0] contains the matrix
-  //  with all row[0] values equal to 1 and all other values equal to 0.
-  std::vector<Eigen::Matrix<double, Eigen::Dynamic, _Dimension> > columns_;
+  /**
+   * UpdateMode getUpdateMode(void)
+   *
+   * @return How this tracker keeps its statistics current.
+   */
+  UpdateMode getUpdateMode(void) const
+  {
+    return update_mode_;
+  }
 
   /**
-   * Eigen::Matrix<double, Eigen::Dynamic, _Dimension> getResiduals(void)
+   * void setCompensatedSummation(bool compensate)
    *
-   * Updates residuals_, so returns nothing. 
+   * In INCREMENTAL mode, accumulates the running mean and co-moment with 
+   * Neumaier (compensated) summation, which carries the rounding error of 
+   * each rank-1 update forward instead of dropping it. Roughly triples the 
+   * cost of each single-datum update; batches are unaffected. Off by 
+   * default.
+   * @param compensate Whether to use compensated summation.
    */
-  void calculateResiduals(void);
-};
+  void setCompensatedSummation(bool compensate);
 
-/**
- * The CovarianceTracker class. Analyzes X-dimensional values (from a sensor, 
- * perhaps) and calculates the covariance matrix of an input set of data.
- * 
- * @author Joshua Petrin
- * @author joshua.m.petrin@vanderbilt.edu
- * @author Vanderbilt Robotics
- * @since March 2018
- * @version 0.1?
- * @brief Calculate the covariance of a set of X-dimensional values.
- */
+  /**
+   * bool getCompensatedSummation(void)
+   *
+   * @return Whether compensated summation is in use.
+   */
+  bool getCompensatedSummation(void) const
+  {
+    return compensated_;
+  }
 
-#ifndef COVARIANCETRACKER_CPP
-#define COVARIANCETRACKER_CPP
+  /**
+   * void setReanchorPeriod(int period)
+   *
+   * In INCREMENTAL mode, periodically replaces the running statistics with 
+   * ones that were built by adding data only, which removes whatever drift 
+   * the downdates of evicted data have accumulated. Once period data have 
+   * been added since the last re-anchoring and the window is full, a shadow
+   * copy of the statistics starts from empty and takes every new datum; 
+   * after getDataLength() more data it summarizes exactly the window and is
+   * swapped in. This spreads the exact recomputation over the window, so no 
+   * single addData() costs more than two rank-1 updates. The effective 
+   * period is therefore at least getDataLength(). A batch that would 
+   * overshoot the shadow restarts it.
+   * @param period The number of data between re-anchorings, or 0 (the 
+   *               default) to never re-anchor.
+   */
+  void setReanchorPeriod(int period);
 
-//#if __cplusplus <= 199711L
-// #error This library needs at least C++11! Compile with -std=c++11 or gnu++11.
-//#endif
+  /**
+   * int getReanchorPeriod(void)
+   *
+   * @return The number of data between re-anchorings, or 0 if disabled.
+   */
+  int getReanchorPeriod(void) const
+  {
+    return reanchor_period_;
+  }
 
+  /**
+   * void setCholeskyTracking(bool track)
+   *
+   * In INCREMENTAL mode, keeps the Cholesky factor of the co-moment current
+   * with an O(_Dimension^2) rank-1 update for every added datum and a 
+   * downdate for every evicted one, so getCholesky(), solve() and 
+   * logDeterminant() only refactorize from scratch once every 
+   * getDataLength() updates, to bound their accumulated rounding error. A 
+   * downdate that would lose positive-definiteness, a batch or a 
+   * re-anchoring also falls back to a full O(_Dimension^3) refactorization 
+   * on the next query. Off by default,
+   * in which case every query after new data refactorizes.
+   * @param track Whether to maintain the factor on insertion.
+   */
+  void setCholeskyTracking(bool track)
+  {
+    cholesky_tracking_ = track;
+  }
 
-/**
- * Constructor. The covariance values are set to 0. Data length defaults to 100.
- */
-template <typename _Scalar, int _Dimension>
-CovarianceTracker<_Scalar, _Dimension>::CovarianceTracker(int len)
-  : update_mean_(false),
-    update_cov_(false),
-    update_residuals_(false),
-    newest_data_(-1),
-    num_used_data_(0),
-    mean_(),
-    data_length_(len),
-    data_double_(len, _Dimension),
-    residuals_(len, _Dimension),
-    covariance_(Eigen::Matrix<double, _Dimension, _Dimension>::Zero()),
-    columns_(_Dimension, 
-      Eigen::Matrix<double, Eigen::Dynamic, _Dimension>::Zero(len, _Dimension))
-{
-  // Set the columns_ vector matrices to 1-columns (see header description)
-  for (int i = 0; i < _Dimension; ++i)
+  /**
+   * bool getCholeskyTracking(void)
+   *
+   * @return Whether the Cholesky factor is maintained on insertion.
+   */
+  bool getCholeskyTracking(void) const
   {
-    for (int j = 0; j < len; ++j)
-    {
-      columns_[i](j, i) = 1.0;
-    }
+    return cholesky_tracking_;
   }
-}
 
-/**
- * double addData(Eigen::Matrix<_Scalar, _Dimension, 1> point)
- *
- * Adds the specified data point to this tracker. Example:
- * <pre>
- * {@code
- * CovarianceTracker<float, 3> cov(100);
- * Eigen::Matrix<float, 3, 1> datapoint;  // datapoint is a 3-vector
- * datapoint << 1.0, 2.0, 3.0;  // datapoint is now <1.0, 2.0, 3.0>
- * cov.addData(datapoint);
- * }
- * </pre>
- * 
- * @param point The vector data point to add. Note this _must_ be a vector of
- *              identical length to _Dimension.
- * @return The fraction of the stored data matrix that is used. 
- */
-template <typename _Scalar, int _Dimension>
-double CovarianceTracker<_Scalar, _Dimension>
-::addData(const Eigen::Matrix<_Scalar, _Dimension, 1> &point)
-{
-  // update the newest data marker
-  ++newest_data_;
-  newest_data_ %= data_length_;
+  /**
+   * const Eigen::Matrix<double, _Dimension, _Dimension>& getCholesky(void) 
+   *   const
+   *
+   * @return The lower-triangular Cholesky factor L of the covariance, 
+   *         L * L^T = getCovariance(), or zeros if the covariance is not 
+   *         positive definite (getDimension() or fewer data) or too nearly
+   *         singular to factor reliably (e.g. collinear data). Cached like 
+   *         getCovariance().
+   */
+  const Eigen::Matrix<double, _Dimension, _Dimension> &getCholesky(void) 
+    const;
 
-  // keep increasing num_used_data_ unless we have reached maximum
-  if (num_used_data_ < data_length_)
-    ++num_used_data_;
+  /**
+   * Eigen::Matrix<double, _Dimension, 1> 
+   * solve(const Eigen::Matrix<double, _Dimension, 1> &b) const
+   *
+   * Solves getCovariance() * x = b with the Cholesky factor, in 
+   * O(_Dimension^2) once the factor is current.
+   * @param b The right-hand side.
+   * @return x, or NaNs if the covariance is not positive definite.
+   */
+  Eigen::Matrix<double, _Dimension, 1> 
+  solve(const Eigen::Matrix<double, _Dimension, 1> &b) const;
 
-  // insert new data into the matrix
-  for (int i = 0; i < _Dimension; ++i)
-    data_double_(newest_data_, i) = static_cast<double>(point(i));
+  /**
+   * double logDeterminant(void) const
+   *
+   * @return The natural logarithm of the determinant of the covariance, 
+   *         from the diagonal of its Cholesky factor, or -infinity if the 
+   *         covariance is not positive definite.
+   */
+  double logDeterminant(void) const;
 
-  // For debugging.
-  //std::cout << data_ << std::endl;
-  //std::cout << residuals_ << std::endl;
-  
-  // alert return functions that the data has changed
-  update_mean_ = true;
-  update_cov_ = true;
-  update_residuals_ = true;
+  /**
+   * void setPrecisionTracking(bool track)
+   *
+   * In INCREMENTAL mode, keeps the inverse of the co-moment current with a 
+   * Sherman-Morrison update for every added and evicted datum, so 
+   * getPrecision() costs O(_Dimension^2) per datum instead of 
+   * O(_Dimension^3) per query. The updates start from an exact inversion 
+   * that passed the conditioning test of getCholesky(). An update that 
+   * would amplify the rounding error in the inverse by over 100x relative 
+   * to its trace, or that leaves a non-positive diagonal, falls back to an
+   * exact inversion on the next query, as do batches and re-anchorings. 
+   * Rounding error in the updates accumulates regardless of 
+   * setReanchorPeriod(), so the inverse is also recomputed exactly after 
+   * every getDataLength() updates. Off by default.
+   * @param track Whether to maintain the inverse on insertion.
+   */
+  void setPrecisionTracking(bool track)
+  {
+    precision_tracking_ = track;
+  }
 
-  return getFractionUsed();
-}
+  /**
+   * bool getPrecisionTracking(void)
+   *
+   * @return Whether the inverse is maintained on insertion.
+   */
+  bool getPrecisionTracking(void) const
+  {
+    return precision_tracking_;
+  }
 
-/**
- * double addData(_Scalar a1, ...)
- *
- * Do NOT try to use this function. It introduces several problems in the 
- * way arguments are passed via the stack. Odds are, if you use it, you will 
- * use it incorrectly, your covariance will be garbage, and you will come 
- * complaining to me about a problem that has already become obsolete. 
- * 
- * <strike>Adds the specified data point to this tracker. <b>WARNING!</b> Does
- * not check for number of arguments, and does not check for size of
- * primitives!! If you pass too few, you will get undefined behavior and 
- * probably a null reference exception. If you pass too many, the last 
- * number(s) will be lost. If you pass a different type than what you 
- * specified in your template, you will get bad data. So, <i>ensure you have 
+  /**
+   * const Eigen::Matrix<double, _Dimension, _Dimension>& getPrecision(void) 
+   *   const
+   *
+   * @return The precision matrix, the inverse of getCovariance(), or zeros
+   *         if the covariance is not positive definite. Cached like 
+   *         getCovariance().
+   */
+  const Eigen::Matrix<double, _Dimension, _Dimension> &getPrecision(void) 
+    const;
+
+private:
+  // The caches below are refreshed lazily by the const getters.
+  mutable bool update_mean_, update_cov_, update_residuals_;
+  int newest_data_;  // The pointer to the newest value inserted.
+  int num_used_data_;  // The number of data used.
+  mutable Eigen::Matrix<double, _Dimension, 1> mean_;
+  int data_length_;  // The window length; data_ may have more rows.
+  const int dimension_;
+  const UpdateMode update_mode_;
+  Eigen::Matrix<_Storage, Eigen::Dynamic, _Dimension, kWindowOptions> data_;
+  // The centered window in RECOMPUTE mode. In INCREMENTAL mode only the 
+  //  staging area for batches and resizes, so it grows to the largest of 
+  //  those instead of being allocated with the window.
+  mutable Eigen::Matrix<double, Eigen::Dynamic, _Dimension, kWindowOptions> 
+    residuals_;
+  mutable Eigen::Matrix<double, _Dimension, _Dimension> covariance_;
+  // Sum of the outer products of the residuals, kept current in INCREMENTAL
+  //  mode. The covariance is comoment_ / (num_used_data_ - 1). Packed, so 
+  //  updates only touch the upper triangle.
+  PackedMatrix comoment_;
+  // Scratch for the difference between a datum and the running mean.
+  Eigen::Matrix<double, _Dimension, 1> delta_;
+  // Scratch for the datum being folded into the statistics, in double and 
+  //  contiguous unlike a row of data_.
+  Eigen::Matrix<double, _Dimension, 1> sample_;
+
+  bool compensated_;
+  // Rounding error carried by compensated summation; only sized when in use.
+  Eigen::Matrix<double, _Dimension, 1> mean_compensation_;
+  PackedMatrix comoment_compensation_;
+
+  int reanchor_period_;
+  int since_anchor_;  // Data added since the last re-anchoring.
+  // The add-only statistics that replace the running ones when they cover 
+  //  the whole window; shadow_count_ < 0 while no re-anchoring is under way.
+  int shadow_count_;
+  Eigen::Matrix<double, _Dimension, 1> shadow_mean_;
+  PackedMatrix shadow_comoment_;
+
+  bool cholesky_tracking_;
+  // Whether comoment_llt_ factors the current co-moment (not the 
+  //  covariance, so rank-1 updates need no rescaling as the count changes).
+  mutable bool cholesky_current_;
+  mutable bool update_cholesky_;  // Whether cholesky_ is stale.
+  mutable Eigen::LLT<Eigen::Matrix<double, _Dimension, _Dimension> > 
+    comoment_llt_;
+  mutable Eigen::Matrix<double, _Dimension, _Dimension> cholesky_;
+  // Below this ratio of the smallest to the largest pivot of the co-moment,
+  //  i.e. about sqrt(epsilon), the factor is treated as singular: its 
+  //  inverse would be mostly rounding error.
+  static constexpr double kMinPivotRatio = 1.5e-8;
+
+  // Above this, a Sherman-Morrison update is treated as ill-conditioned: it 
+  //  would amplify the relative rounding error in the inverse by over 100x.
+  static constexpr double kMaxShermanMorrisonAmplification = 1e2;
+  bool precision_tracking_;
+  // Whether inverse_comoment_ is the inverse of the current co-moment.
+  mutable bool precision_current_;
+  // Rank-1 updates applied to the factorizations since the co-moment was 
+  //  last factorized from scratch.
+  mutable int factorization_updates_;
+  mutable bool update_precision_;  // Whether precision_ is stale.
+  mutable Eigen::Matrix<double, _Dimension, _Dimension> inverse_comoment_;
+  mutable Eigen::Matrix<double, _Dimension, _Dimension> precision_;
+  // Scratch for the inverse co-moment times delta_.
+  Eigen::Matrix<double, _Dimension, 1> precision_scratch_;
+
+  uint64_t rejections_;  // The number of data addDataGated() rejected.
+
+  // Whether std_dev_ and correlation_ are stale; they are refreshed 
+  //  together.
+  mutable bool update_correlation_;
+  mutable Eigen::Matrix<double, _Dimension, 1> std_dev_;
+  mutable Eigen::Matrix<double, _Dimension, _Dimension> correlation_;
+
+  // Jacobi sweeps give up after this many, far more than convergence takes.
+  static const int kMaxJacobiSweeps = 32;
+  double eigen_tolerance_;
+  mutable bool update_axes_;  // Whether the eigendecomposition is stale.
+  mutable int last_sweeps_;
+  // The eigenvectors, kept between refreshes as the warm start.
+  mutable Eigen::Matrix<double, _Dimension, _Dimension> eigenvectors_;
+  mutable Eigen::Matrix<double, _Dimension, 1> eigenvalues_;
+  // Scratch for the covariance rotated into the eigenvectors.
+  mutable Eigen::Matrix<double, _Dimension, _Dimension> rotated_;
+
+  /**
+   * void reserveResiduals(int rows) const
+   *
+   * Grows residuals_ to at least rows rows. Its contents are scratch, so 
+   * they are not kept.
+   */
+  void reserveResiduals(int rows) const
+  {
+    if (residuals_.rows() < rows)
+      residuals_.resize(rows, dimension_);
+  }
+
+  /**
+   * void calculateResiduals(void)
+   *
+   * Updates the first num_used_data_ rows of residuals_ in place by 
+   * subtracting mean_ from every stored datum, so returns nothing. Allocates
+   * no memory.
+   */
+  void calculateResiduals(void) const;
+
+  /**
+   * void addToStatistics(int count)
+   *
+   * Folds the datum in sample_ into the running mean and co-moment as a 
+   * rank-1 update. Does not touch num_used_data_.
+   * @param count The number of data in the statistics before the update.
+   */
+  void addToStatistics(int count);
+
+  /**
+   * void removeFromStatistics(int count)
+   *
+   * Removes the datum in sample_ from the running mean and co-moment as a 
+   * rank-1 downdate. Does not touch num_used_data_.
+   * @param count The number of data in the statistics before the update.
+   */
+  void removeFromStatistics(int count);
+
+  /**
+   * template <typename _Derived>
+   * double insertBatch(const Eigen::MatrixBase<_Derived> &points)
+   *
+   * Implements both addBatch() overloads; points is any rows x dimension_ 
+   * expression.
+   */
+  template <typename _Derived>
+  double insertBatch(const Eigen::MatrixBase<_Derived> &points);
+
+  /**
+   * void addBlockToStatistics(int rows, int count)
+   *
+   * Merges the data held in the first rows rows of residuals_ into the 
+   * running statistics (Chan et al.), overwriting residuals_ on the way.
+   * @param rows The number of data to merge.
+   * @param count The number of data in the statistics before the update.
+   */
+  void addBlockToStatistics(int rows, int count);
+
+  /**
+   * void removeBlockFromStatistics(int rows, int count)
+   *
+   * The inverse of addBlockToStatistics(): removes the data held in the 
+   * first rows rows of residuals_ from the running statistics.
+   * @param rows The number of data to remove.
+   * @param count The number of data in the statistics before the update.
+   */
+  void removeBlockFromStatistics(int rows, int count);
+
+  /**
+   * void mergeCenteredBlock(int rows, int count, 
+   *                         Eigen::Matrix<double, _Dimension, 1> &mean,
+   *                         PackedMatrix &comoment)
+   *
+   * Merges a block whose mean is in sample_ and whose centered data are in 
+   * the first rows rows of residuals_ into the given statistics.
+   * @param count The number of data in the statistics before the update.
+   */
+  void mergeCenteredBlock(int rows, int count,
+                          Eigen::Matrix<double, _Dimension, 1> &mean,
+                          PackedMatrix &comoment);
+
+  /**
+   * void accumulateGram(int rows, double sign, PackedMatrix &comoment) const
+   *
+   * comoment += sign * R^T * R, where R is the first rows rows of 
+   * residuals_, computing only the upper triangle.
+   */
+  void accumulateGram(int rows, double sign, PackedMatrix &comoment) const;
+
+  /**
+   * void advanceReanchoring(int rows)
+   *
+   * Called after rows new data have been added to the running statistics 
+   * (and, for a single datum, to the shadow). Starts a re-anchoring when one 
+   * is due, and swaps the shadow in once it covers the window.
+   * @param rows The number of data just added.
+   */
+  void advanceReanchoring(int rows);
+
+  /**
+   * void recomputeStatistics(void)
+   *
+   * Recalculates the running mean and co-moment exactly from the filled 
+   * rows of data_, overwriting residuals_.
+   */
+  void recomputeStatistics(void);
+
+  /**
+   * void updateFactorizations(double weight)
+   *
+   * Called after a rank-1 update comoment += weight * delta_ * delta_^T. 
+   * Applies the same update to the Cholesky factor and the inverse 
+   * co-moment, or marks each stale if its tracking is off or the update 
+   * failed its checks.
+   */
+  void updateFactorizations(double weight);
+
+  /**
+   * void invalidateFactorizations(void) const
+   *
+   * Marks the Cholesky factor and the inverse co-moment stale after a 
+   * change that is not a rank-1 update.
+   */
+  void invalidateFactorizations(void) const
+  {
+    cholesky_current_ = false;
+    precision_current_ = false;
+  }
+
+  /**
+   * void calculateCorrelation(void) const
+   *
+   * Refreshes std_dev_ and correlation_ from getCovariance() if stale.
+   */
+  void calculateCorrelation(void) const;
+
+  /**
+   * void calculatePrincipalAxes(void) const
+   *
+   * Refreshes eigenvectors_ and eigenvalues_ from getCovariance() if stale,
+   * warm-started from the current eigenvectors_.
+   */
+  void calculatePrincipalAxes(void) const;
+
+  /**
+   * bool invertComoment(void) const
+   *
+   * Recomputes the inverse co-moment exactly from the Cholesky factor 
+   * unless it is already current.
+   * @return Whether the co-moment is positive definite.
+   */
+  bool invertComoment(void) const;
+
+  /**
+   * bool factorizeCholesky(void) const
+   *
+   * Refactorizes the co-moment from scratch unless comoment_llt_ is 
+   * already current.
+   * @return Whether the co-moment is positive definite: there are more 
+   *         data than variables and the factor is well-conditioned.
+   */
+  bool factorizeCholesky(void) const;
+
+  /**
+   * bool isConditioned(void) const
+   *
+   * @return Whether the pivots of comoment_llt_, the squares of the 
+   *         diagonal of its factor, are within kMinPivotRatio of each other.
+   */
+  bool isConditioned(void) const
+  {
+    const auto pivots = comoment_llt_.matrixLLT().diagonal().array().square();
+    return pivots.minCoeff() >= kMinPivotRatio * pivots.maxCoeff();
+  }
+};
+
+/**
+ * The CovarianceTracker class. Analyzes X-dimensional values (from a sensor, 
+ * perhaps) and calculates the covariance matrix of an input set of data.
+ * 
+ * @author Joshua Petrin
+ * @author joshua.m.petrin@vanderbilt.edu
+ * @author Vanderbilt Robotics
+ * @since March 2018
+ * @version 0.1?
+ * @brief Calculate the covariance of a set of X-dimensional values.
+ */
+
+#ifndef COVARIANCETRACKER_CPP
+#define COVARIANCETRACKER_CPP
+
+//#if __cplusplus <= 199711L
+// #error This library needs at least C++11! Compile with -std=c++11 or gnu++11.
+//#endif
+
+
+/**
+ * Constructor. The covariance values are set to 0. Data length defaults to 100.
+ */
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::CovarianceTracker(int len, UpdateMode mode)
+  : CovarianceTracker(len, _Dimension, mode)
+{
+  static_assert(_Dimension != Eigen::Dynamic, 
+    "A CovarianceTracker with a runtime dimension needs the dimension passed"
+    " to its constructor.");
+}
+
+/**
+ * Constructor for a tracker whose dimension is chosen at runtime.
+ */
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::CovarianceTracker(int len, int dimension, UpdateMode mode)
+  : update_mean_(false),
+    update_cov_(false),
+    update_residuals_(false),
+    newest_data_(-1),
+    num_used_data_(0),
+    mean_(Eigen::Matrix<double, _Dimension, 1>::Zero(dimension)),
+    data_length_(len),
+    dimension_(dimension),
+    update_mode_(mode),
+    data_(len, dimension),
+    residuals_((mode == RECOMPUTE) ? len : 0, dimension),
+    covariance_(Eigen::Matrix<double, _Dimension, _Dimension>
+                ::Zero(dimension, dimension)),
+    comoment_(PackedMatrix::Zero(dimension * (dimension + 1) / 2)),
+    delta_(dimension),
+    sample_(dimension),
+    compensated_(false),
+    mean_compensation_(),
+    comoment_compensation_(),
+    reanchor_period_(0),
+    since_anchor_(0),
+    shadow_count_(-1),
+    shadow_mean_(),
+    shadow_comoment_(),
+    cholesky_tracking_(false),
+    cholesky_current_(false),
+    update_cholesky_(true),
+    comoment_llt_(dimension),
+    cholesky_(Eigen::Matrix<double, _Dimension, _Dimension>
+              ::Zero(dimension, dimension)),
+    precision_tracking_(false),
+    precision_current_(false),
+    factorization_updates_(0),
+    update_precision_(true),
+    inverse_comoment_(dimension, dimension),
+    precision_(Eigen::Matrix<double, _Dimension, _Dimension>
+               ::Zero(dimension, dimension)),
+    precision_scratch_(dimension),
+    rejections_(0),
+    update_correlation_(true),
+    std_dev_(dimension),
+    correlation_(dimension, dimension),
+    eigen_tolerance_(1e-12),
+    update_axes_(true),
+    last_sweeps_(0),
+    eigenvectors_(Eigen::Matrix<double, _Dimension, _Dimension>
+                  ::Identity(dimension, dimension)),
+    eigenvalues_(Eigen::Matrix<double, _Dimension, 1>::Zero(dimension)),
+    rotated_(dimension, dimension)
+{
+  assert(dimension > 0);
+  assert(_Dimension == Eigen::Dynamic || dimension == _Dimension);
+}
+
+/**
+ * double addData(Eigen::Matrix<_Scalar, _Dimension, 1> point)
+ *
+ * Adds the specified data point to this tracker. Example:
+ * <pre>
+ * {@code
+ * CovarianceTracker<float, 3> cov(100);
+ * Eigen::Matrix<float, 3, 1> datapoint;  // datapoint is a 3-vector
+ * datapoint << 1.0, 2.0, 3.0;  // datapoint is now <1.0, 2.0, 3.0>
+ * cov.addData(datapoint);
+ * }
+ * </pre>
+ * 
+ * @param point The vector data point to add. Note this _must_ be a vector of
+ *              identical length to getDimension().
+ * @return The fraction of the stored data matrix that is used. 
+ */
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+double CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::addData(const Eigen::Matrix<_Scalar, _Dimension, 1> &point)
+{
+  assert(point.size() == dimension_);
+  return addData(point.data());
+}
+
+/**
+ * double addData(_Scalar a1, ...)
+ *
+ * Do NOT try to use this function. It introduces several problems in the 
+ * way arguments are passed via the stack. Odds are, if you use it, you will 
+ * use it incorrectly, your covariance will be garbage, and you will come 
+ * complaining to me about a problem that has already become obsolete. 
+ * 
+ * <strike>Adds the specified data point to this tracker. <b>WARNING!</b> Does
+ * not check for number of arguments, and does not check for size of
+ * primitives!! If you pass too few, you will get undefined behavior and 
+ * probably a null reference exception. If you pass too many, the last 
+ * number(s) will be lost. If you pass a different type than what you 
+ * specified in your template, you will get bad data. So, <i>ensure you have 
  * the correct _Dimension templated, and ensure you are passing your 
  * arguments correctly.</i></strike>
  * @param a1... The data point to add. Must have length _Dimension and type
@@ -302,80 +1080,421 @@ double CovarianceTracker<_Scalar, _Dimension>
  * double addData(const std::vector<_Scalar> point)
  *
  * Adds the specified data point to this tracker. Asserts the size of point
- * is equal to _Dimension! So only pass the correct number of arguments or
- * you will get a runtime error. 
+ * is equal to getDimension()! So only pass the correct number of arguments
+ * or you will get a runtime error. 
  * @param point The std::vector<_Scalar> containing the data
  * @return The fraction of the stored data matrix that is used.
  */
-template <typename _Scalar, int _Dimension>
-double CovarianceTracker<_Scalar, _Dimension>
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+double CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
 ::addData(const std::vector<_Scalar> &point)
 {
   // point.size() MUST be equal to the Dimension of this 
-  assert(point.size() == _Dimension);
-  Eigen::Matrix<_Scalar, _Dimension, 1> p;
-  for (int i = 0; i < _Dimension; ++i)
-    p(i) = point[i];
-  return addData(p);
+  assert(static_cast<int>(point.size()) == dimension_);
+  return addData(point.data());
 }
 
 /**
  * double addData(const _Scalar[] point)
  *
  * Receives a _Scalar array to be used as a data point. If the input array 
- * does not have a length _Dimension, memory will be grabbed that does not
- * belong to the array, which will lead to undefined behavior. 
+ * does not have a length getDimension(), memory will be grabbed that does 
+ * not belong to the array, which will lead to undefined behavior. 
  * @param point The _Scalar array that contains the data point to add.
  * @return The fraction of the stored data matrix that is used.
  */
-template <typename _Scalar, int _Dimension>
-double CovarianceTracker<_Scalar, _Dimension>::addData(const _Scalar point[])
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+double CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::addData(const _Scalar point[])
+{
+  // update the newest data marker
+  ++newest_data_;
+  newest_data_ %= data_length_;
+
+  // the datum about to be overwritten leaves the running statistics
+  if (update_mode_ == INCREMENTAL && num_used_data_ == data_length_) {
+    sample_ = data_.row(newest_data_).transpose().template cast<double>();
+    removeFromStatistics(num_used_data_);
+    --num_used_data_;
+  }
+
+  // keep increasing num_used_data_ unless we have reached maximum
+  if (num_used_data_ < data_length_)
+    ++num_used_data_;
+
+  // insert new data into the matrix
+  for (int i = 0; i < dimension_; ++i) {
+    data_(newest_data_, i) = static_cast<_Storage>(point[i]);
+    sample_(i) = static_cast<double>(point[i]);
+  }
+
+  if (update_mode_ == INCREMENTAL) {
+    addToStatistics(num_used_data_ - 1);
+    if (shadow_count_ >= 0) {
+      covariance_kernels::Dispatch<_Dimension>::template 
+        run<covariance_kernels::PackedWelfordAdd>(dimension_, shadow_count_, 
+                                            sample_.data(), 
+                                            shadow_mean_.data(), 
+                                            shadow_comoment_.data(),
+                                            delta_.data());
+      ++shadow_count_;
+    }
+    advanceReanchoring(1);
+  } else {
+    invalidateFactorizations();
+  }
+
+  // For debugging.
+  //std::cout << data_ << std::endl;
+  //std::cout << residuals_ << std::endl;
+  
+  // alert return functions that the data has changed
+  update_mean_ = true;
+  update_cov_ = true;
+  update_residuals_ = true;
+  update_cholesky_ = true;
+  update_precision_ = true;
+  update_correlation_ = true;
+  update_axes_ = true;
+
+  return getFractionUsed();
+}
+
+/**
+ * double addDataGated(const _Scalar point[], double threshold)
+ *
+ * Adds point only if its squared Mahalanobis distance from the current data
+ * is at most threshold.
+ * @return The squared Mahalanobis distance of point.
+ */
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+double CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::addDataGated(const _Scalar point[], double threshold)
+{
+  for (int i = 0; i < dimension_; ++i)
+    delta_(i) = static_cast<double>(point[i]);
+  delta_ -= getMean();
+
+  // d^T * covariance^-1 * d = (n - 1) * d^T * comoment^-1 * d, from 
+  //  whichever factorization is cheaper to bring up to date
+  double distance = 0.0;
+  if (precision_tracking_ && invertComoment()) {
+    precision_scratch_.noalias() = inverse_comoment_ * delta_;
+    distance = delta_.dot(precision_scratch_);
+  } else if (factorizeCholesky()) {
+    precision_scratch_ = delta_;
+    comoment_llt_.matrixL().solveInPlace(precision_scratch_);
+    distance = precision_scratch_.squaredNorm();
+  }
+  distance *= std::max(static_cast<double>(num_used_data_) - 1.0, 0.0);
+
+  if (distance > threshold && num_used_data_ == data_length_) {
+    ++rejections_;
+    return distance;
+  }
+  addData(point);
+  return distance;
+}
+
+/**
+ * double addBatch(const Eigen::Ref<const Eigen::Matrix<_Scalar, 
+ *                 Eigen::Dynamic, _Dimension> > &points)
+ *
+ * Adds every row of points to this tracker, oldest first, as if addData()
+ * were called once per row.
+ * @param points The data to add, one datum per row.
+ * @return The fraction of the stored data matrix that is used.
+ */
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+double CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::addBatch(const Eigen::Ref<
+           const Eigen::Matrix<_Scalar, Eigen::Dynamic, _Dimension> > &points)
 {
-  Eigen::Matrix<_Scalar, _Dimension, 1> p;
-  for (int i = 0; i < _Dimension; ++i)
-    p(i) = point[i];
-  return addData(p);
+  assert(points.cols() == dimension_);
+  return insertBatch(points);
 }
 
 /**
- * Eigen::Matrix<>& getCovariance(void)
+ * double addBatch(const _Scalar points[], int count)
+ *
+ * Adds count data stored back to back in points.
+ * @param points The _Scalar array that contains the data to add.
+ * @param count The number of data in points.
+ * @return The fraction of the stored data matrix that is used.
+ */
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+double CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::addBatch(const _Scalar points[], int count)
+{
+  // each datum is a contiguous column of this map, so its transpose has one
+  //  datum per row
+  Eigen::Map<const Eigen::Matrix<_Scalar, _Dimension, Eigen::Dynamic> > 
+    columns(points, dimension_, count);
+  return insertBatch(columns.transpose());
+}
+
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+template <typename _Derived>
+double CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::insertBatch(const Eigen::MatrixBase<_Derived> &points)
+{
+  const int count = static_cast<int>(points.rows());
+  if (count == 0)
+    return getFractionUsed();
+  // a block update is not a rank-1 update; refactorize on the next query
+  invalidateFactorizations();
+
+  if (count >= data_length_) {
+    // only the newest data_length_ rows survive; lay them out in order
+    data_.topRows(data_length_) = 
+      points.bottomRows(data_length_).template cast<_Storage>();
+    newest_data_ = data_length_ - 1;
+    num_used_data_ = data_length_;
+    if (update_mode_ == INCREMENTAL) {
+      // an exact recomputation is as good as a re-anchoring
+      recomputeStatistics();
+      shadow_count_ = -1;
+      since_anchor_ = 0;
+    }
+  } else {
+    const int start = (newest_data_ + 1) % data_length_;
+    const int evicted = std::max(0, num_used_data_ + count - data_length_);
+    const int first = std::min(count, data_length_ - start);
+
+    if (update_mode_ == INCREMENTAL)
+      reserveResiduals(count);
+    if (update_mode_ == INCREMENTAL && evicted > 0) {
+      // the evicted data are the oldest ones, which are exactly the filled
+      //  rows about to be overwritten
+      const int oldest = (newest_data_ + 1 - num_used_data_ + data_length_) 
+                         % data_length_;
+      const int head = std::min(evicted, data_length_ - oldest);
+      residuals_.topRows(head) = 
+        data_.middleRows(oldest, head).template cast<double>();
+      residuals_.middleRows(head, evicted - head) = 
+        data_.topRows(evicted - head).template cast<double>();
+      removeBlockFromStatistics(evicted, num_used_data_);
+    }
+
+    data_.middleRows(start, first) = 
+      points.topRows(first).template cast<_Storage>();
+    data_.topRows(count - first) = 
+      points.bottomRows(count - first).template cast<_Storage>();
+    // residuals_ doubles as the staging area for the batch statistics
+    if (update_mode_ == INCREMENTAL)
+      residuals_.topRows(count) = points.template cast<double>();
+
+    if (update_mode_ == INCREMENTAL)
+      addBlockToStatistics(count, num_used_data_ - evicted);
+
+    newest_data_ = (newest_data_ + count) % data_length_;
+    num_used_data_ += count - evicted;
+
+    if (update_mode_ == INCREMENTAL)
+      advanceReanchoring(count);
+  }
+
+  // alert return functions that the data has changed
+  update_mean_ = true;
+  update_cov_ = true;
+  update_residuals_ = true;
+  update_cholesky_ = true;
+  update_precision_ = true;
+  update_correlation_ = true;
+  update_axes_ = true;
+
+  return getFractionUsed();
+}
+
+/**
+ * void resize(int len)
+ *
+ * Changes the window length in place, keeping the most recent data.
+ */
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+void CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::resize(int len)
+{
+  assert(len > 0);
+  const int kept = std::min(num_used_data_, len);
+  const int evicted = num_used_data_ - kept;
+  // the oldest datum, and the first one that is kept
+  const int oldest = (newest_data_ + 1 - num_used_data_ + data_length_) 
+                     % data_length_;
+  const int first = (oldest + evicted) % data_length_;
+
+  if (update_mode_ == INCREMENTAL && evicted > 0) {
+    reserveResiduals(evicted);
+    const int head = std::min(evicted, data_length_ - oldest);
+    residuals_.topRows(head) = 
+      data_.middleRows(oldest, head).template cast<double>();
+    residuals_.middleRows(head, evicted - head) = 
+      data_.topRows(evicted - head).template cast<double>();
+    removeBlockFromStatistics(evicted, num_used_data_);
+  }
+  // the factorizations describe the old window in either mode
+  if (evicted > 0)
+    invalidateFactorizations();
+
+  // rotate the ring in place so the kept data start at row 0, oldest 
+  //  first; INCREMENTAL mode then needs no window-sized scratch
+  _Storage *ring = data_.data();
+  if (kWindowOptions & Eigen::RowMajor) {
+    std::rotate(ring, ring + first * dimension_, 
+                ring + data_length_ * dimension_);
+  } else {
+    for (int j = 0; j < dimension_; ++j, ring += data_.rows())
+      std::rotate(ring, ring + first, ring + data_length_);
+  }
+  if (len > data_.rows())
+    data_.conservativeResize(len, dimension_);
+  if (update_mode_ == RECOMPUTE)
+    reserveResiduals(len);
+
+  data_length_ = len;
+  num_used_data_ = kept;
+  newest_data_ = kept - 1;
+  // a re-anchoring in progress assumed the old length
+  shadow_count_ = -1;
+
+  // alert return functions that the data has changed
+  update_mean_ = true;
+  update_cov_ = true;
+  update_residuals_ = true;
+  update_cholesky_ = true;
+  update_precision_ = true;
+  update_correlation_ = true;
+  update_axes_ = true;
+}
+
+/**
+ * const Eigen::Matrix<>& getCovariance(void) const
  * 
  * Calculate the covariance matrix. If no data or one datum has been inserted 
  * into this tracker, returns a _Dimension x _Dimension matrix of zeros. 
  * @return The current calculated covariance matrix. 
  */
-template <typename _Scalar, int _Dimension>
-Eigen::Matrix<double, _Dimension, _Dimension> 
-CovarianceTracker<_Scalar, _Dimension>::getCovariance(void)
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+const Eigen::Matrix<double, _Dimension, _Dimension> &
+CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>::getCovariance(void) const
 {
-  if (update_cov_ && num_used_data_ > 1) {
+  if (update_cov_ && num_used_data_ > 1 && update_mode_ == INCREMENTAL) {
+    // the co-moment is already current, so just scale and expand it
+    update_cov_ = false;
+    covariance_kernels::Dispatch<_Dimension>::template 
+      run<covariance_kernels::UnpackSymmetric>(
+        dimension_, 1.0 / (static_cast<double>(num_used_data_) - 1.0), 
+        comoment_.data(), covariance_.data());
+    return covariance_;
+  } else if (update_cov_ && num_used_data_ > 1) {
     // update fields, if we need to
     getMean();
     calculateResiduals();
-    // calculate new covariance matrix
+    // calculate the upper triangle of the new covariance matrix, one column 
+    //  at a time, and mirror it
+    update_cov_ = false;
+    const auto residuals = residuals_.topRows(num_used_data_);
+    if ((kWindowOptions & Eigen::RowMajor) && _Dimension != Eigen::Dynamic
+        && _Dimension <= kMaxUnrolledGram) {
+      // a column of a row-major window is strided, so sum the outer products
+      //  of whole rows; at fixed small sizes they stay in registers
+      covariance_.setZero();
+      for (int i = 0; i < num_used_data_; ++i)
+        covariance_.noalias() += 
+          residuals.row(i).transpose() * residuals.row(i);
+    } else if (kWindowOptions & Eigen::RowMajor) {
+      // too large to unroll: a blocked symmetric rank-k update over rows
+      covariance_.setZero();
+      covariance_.template selfadjointView<Eigen::Upper>()
+        .rankUpdate(residuals.transpose());
+    } else {
+      for (int j = 0; j < dimension_; ++j) {
+        covariance_.col(j).head(j + 1).noalias() = 
+          residuals.leftCols(j + 1).transpose() * residuals.col(j);
+      }
+    }
+    covariance_.template triangularView<Eigen::StrictlyLower>() = 
+      covariance_.transpose();
+    return covariance_ /= (static_cast<double>(num_used_data_) - 1.0);
+  } else if (update_cov_) {
+    // resize() can leave fewer than two data behind a stale matrix
     update_cov_ = false;
-    return covariance_ = 
-                (residuals_.block(0, 0, num_used_data_, _Dimension).transpose()
-                * residuals_.block(0, 0, num_used_data_, _Dimension)).eval()
-                / (static_cast<double>(num_used_data_) - 1.0);
+    return covariance_.setZero();
   } else {
     return covariance_;
   }
 }
 
 /**
- * Eigen::Matrix<double, _Dimension, 1> getMean(void)
+ * void getCovarianceInto(double *out, int order) const
+ *
+ * Writes the covariance matrix into a caller-owned buffer of 
+ * getDimension()^2 doubles, in the given storage order.
+ */
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+void CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::getCovarianceInto(double *out, int order) const
+{
+  if (order == Eigen::RowMajor) {
+    Eigen::Map<Eigen::Matrix<double, _Dimension, _Dimension, Eigen::RowMajor> >
+      (out, dimension_, dimension_) = getCovariance();
+  } else {
+    Eigen::Map<Eigen::Matrix<double, _Dimension, _Dimension> >
+      (out, dimension_, dimension_) = getCovariance();
+  }
+}
+
+/**
+ * void getCovariancePacked(double *out) const
+ *
+ * Writes the upper triangle of the covariance matrix, column by column, into
+ * a caller-owned buffer of getDimension() * (getDimension() + 1) / 2 doubles.
+ */
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+void CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::getCovariancePacked(double *out) const
+{
+  const int size = dimension_ * (dimension_ + 1) / 2;
+  if (update_mode_ == INCREMENTAL) {
+    const double scale = (num_used_data_ > 1) 
+                         ? 1.0 / (static_cast<double>(num_used_data_) - 1.0)
+                         : 0.0;
+    Eigen::Map<PackedMatrix>(out, size) = comoment_ * scale;
+    return;
+  }
+
+  const Eigen::Matrix<double, _Dimension, _Dimension> &covariance = 
+    getCovariance();
+  for (int j = 0, p = 0; j < dimension_; ++j)
+    for (int i = 0; i <= j; ++i, ++p)
+      out[p] = covariance(i, j);
+}
+
+/**
+ * const Eigen::Matrix<double, _Dimension, 1>& getMean(void) const
  *
  * @return The mean vector of the values stored in this covariance tracker.
  */
-template <typename _Scalar, int _Dimension>
-Eigen::Matrix<double, _Dimension, 1>
-CovarianceTracker<_Scalar, _Dimension>::getMean(void)
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+const Eigen::Matrix<double, _Dimension, 1> &
+CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>::getMean(void) const
 {
-  if (update_mean_) {
-    for (int i = 0; i < _Dimension; ++i) {
-      mean_(i) = data_double_.block(0, 0, num_used_data_, _Dimension)
+  if (update_mean_ && update_mode_ == INCREMENTAL) {
+    // the running mean is updated in addData()
+    update_mean_ = false;
+    return mean_;
+  } else if (update_mean_ && (kWindowOptions & Eigen::RowMajor)) {
+    // sum whole rows at a time, so each datum is read contiguously
+    mean_.noalias() = data_.topRows(num_used_data_).template cast<double>()
+                      .colwise().sum().transpose()
+                      / static_cast<double>(num_used_data_);
+    update_mean_ = false;
+    return mean_;
+  } else if (update_mean_) {
+    for (int i = 0; i < dimension_; ++i) {
+      mean_(i) = data_.topRows(num_used_data_)
                  .col(i)
+                 .template cast<double>()
                  .sum()
                  / static_cast<double>(num_used_data_);
     }
@@ -390,28 +1509,630 @@ CovarianceTracker<_Scalar, _Dimension>::getMean(void)
   }
 }
 
+/**
+ * CovarianceStatistics<_Dimension> getStatistics(void) const
+ *
+ * @return The count, mean and co-moment of the stored data.
+ */
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+CovarianceStatistics<_Dimension> 
+CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::getStatistics(void) const
+{
+  if (num_used_data_ == 0)
+    return CovarianceStatistics<_Dimension>(dimension_);
+  if (update_mode_ == INCREMENTAL) {
+    Eigen::Matrix<double, _Dimension, _Dimension> comoment(dimension_, 
+                                                           dimension_);
+    covariance_kernels::Dispatch<_Dimension>::template 
+      run<covariance_kernels::UnpackSymmetric>(dimension_, 1.0, 
+                                               comoment_.data(), 
+                                               comoment.data());
+    return CovarianceStatistics<_Dimension>(num_used_data_, mean_, comoment);
+  }
+  if (num_used_data_ == 1)
+    return CovarianceStatistics<_Dimension>(1, getMean(), 
+      Eigen::Matrix<double, _Dimension, _Dimension>
+      ::Zero(dimension_, dimension_));
+  return CovarianceStatistics<_Dimension>(num_used_data_, getMean(),
+    getCovariance() * (static_cast<double>(num_used_data_) - 1.0));
+}
 
-template <typename _Scalar, int _Dimension>
-void CovarianceTracker<_Scalar, _Dimension>::calculateResiduals(void)
+/**
+ * void getMeanInto(double *out) const
+ *
+ * Writes the mean vector into a caller-owned buffer of getDimension() 
+ * doubles.
+ */
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+void CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::getMeanInto(double *out) const
 {
-  if (update_residuals_) {
-    // create tmp_means, a matrix with the mean of column x filling the x column
-    Eigen::Matrix<double, Eigen::Dynamic, _Dimension> 
-    tmp_means(data_length_, _Dimension);
-    tmp_means = 
-      Eigen::Matrix<double, Eigen::Dynamic, _Dimension>
-      ::Zero(data_length_, _Dimension);
-    for (int i = 0; i < _Dimension; ++i) {
-        tmp_means += (columns_[i] * mean_(i));
+  Eigen::Map<Eigen::Matrix<double, _Dimension, 1> >(out, dimension_) = 
+    getMean();
+}
+
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+void CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::calculateCorrelation(void) const
+{
+  if (!update_correlation_)
+    return;
+
+  const Eigen::Matrix<double, _Dimension, _Dimension> &covariance = 
+    getCovariance();
+  // std_dev_ briefly holds the reciprocals, with 0 for constant variables
+  for (int i = 0; i < dimension_; ++i) {
+    const double variance = covariance(i, i);
+    std_dev_(i) = (variance > 0.0) ? 1.0 / std::sqrt(variance) : 0.0;
+  }
+  for (int j = 0; j < dimension_; ++j) {
+    for (int i = 0; i < dimension_; ++i)
+      correlation_(i, j) = covariance(i, j) * std_dev_(i) * std_dev_(j);
+    correlation_(j, j) = 1.0;
+  }
+  for (int i = 0; i < dimension_; ++i)
+    std_dev_(i) = std::sqrt(std::max(covariance(i, i), 0.0));
+  update_correlation_ = false;
+}
+
+/**
+ * const Eigen::Matrix<double, _Dimension, 1>& getStdDev(void) const
+ *
+ * @return The standard deviation of each variable.
+ */
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+const Eigen::Matrix<double, _Dimension, 1> &
+CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::getStdDev(void) const
+{
+  calculateCorrelation();
+  return std_dev_;
+}
+
+/**
+ * const Eigen::Matrix<double, _Dimension, _Dimension>& 
+ * getCorrelation(void) const
+ *
+ * @return The correlation matrix.
+ */
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+const Eigen::Matrix<double, _Dimension, _Dimension> &
+CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::getCorrelation(void) const
+{
+  calculateCorrelation();
+  return correlation_;
+}
+
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+void CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::calculatePrincipalAxes(void) const
+{
+  if (!update_axes_)
+    return;
+
+  // in the previous eigenvectors, a slightly changed covariance is nearly 
+  //  diagonal, so only its small off-diagonal remainder needs rotating away
+  rotated_.noalias() = eigenvectors_.transpose() * getCovariance() 
+                       * eigenvectors_;
+  const double limit = eigen_tolerance_ * eigen_tolerance_ 
+                       * rotated_.squaredNorm();
+
+  last_sweeps_ = 0;
+  while (last_sweeps_ < kMaxJacobiSweeps) {
+    // summed directly; the full norm minus the diagonal's would be all 
+    //  cancellation error near convergence
+    double off_diagonal = 0.0;
+    for (int q = 1; q < dimension_; ++q)
+      off_diagonal += 2.0 * rotated_.col(q).head(q).squaredNorm();
+    if (off_diagonal <= limit)
+      break;
+
+    // one cyclic sweep: zero every off-diagonal pair in turn, skipping 
+    //  pairs already small enough that all of them together would pass
+    const double pair_limit = limit / (dimension_ * (dimension_ - 1.0));
+    for (int q = 1; q < dimension_; ++q) {
+      for (int p = 0; p < q; ++p) {
+        if (rotated_(p, q) * rotated_(p, q) <= pair_limit)
+          continue;
+        Eigen::JacobiRotation<double> rotation;
+        if (rotation.makeJacobi(rotated_, p, q)) {
+          rotated_.applyOnTheLeft(p, q, rotation.adjoint());
+          rotated_.applyOnTheRight(p, q, rotation);
+          eigenvectors_.applyOnTheRight(p, q, rotation);
+        }
+      }
+    }
+    ++last_sweeps_;
+  }
+
+  // sort into increasing order, like Eigen::SelfAdjointEigenSolver
+  eigenvalues_ = rotated_.diagonal();
+  for (int i = 0; i < dimension_ - 1; ++i) {
+    int smallest;
+    eigenvalues_.tail(dimension_ - i).minCoeff(&smallest);
+    smallest += i;
+    if (smallest != i) {
+      std::swap(eigenvalues_(i), eigenvalues_(smallest));
+      eigenvectors_.col(i).swap(eigenvectors_.col(smallest));
     }
+  }
+  update_axes_ = false;
+}
+
+/**
+ * const Eigen::Matrix<double, _Dimension, _Dimension>& 
+ * getPrincipalAxes(void) const
+ *
+ * @return The eigenvectors of the covariance, as columns.
+ */
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+const Eigen::Matrix<double, _Dimension, _Dimension> &
+CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::getPrincipalAxes(void) const
+{
+  calculatePrincipalAxes();
+  return eigenvectors_;
+}
+
+/**
+ * const Eigen::Matrix<double, _Dimension, 1>& 
+ * getPrincipalVariances(void) const
+ *
+ * @return The eigenvalues of the covariance, in increasing order.
+ */
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+const Eigen::Matrix<double, _Dimension, 1> &
+CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::getPrincipalVariances(void) const
+{
+  calculatePrincipalAxes();
+  return eigenvalues_;
+}
+
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+void CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::getStdDevInto(double *out) const
+{
+  Eigen::Map<Eigen::Matrix<double, _Dimension, 1> >(out, dimension_) = 
+    getStdDev();
+}
+
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+void CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::getCorrelationInto(double *out, int order) const
+{
+  if (order == Eigen::RowMajor) {
+    Eigen::Map<Eigen::Matrix<double, _Dimension, _Dimension, Eigen::RowMajor> >
+      (out, dimension_, dimension_) = getCorrelation();
+  } else {
+    Eigen::Map<Eigen::Matrix<double, _Dimension, _Dimension> >
+      (out, dimension_, dimension_) = getCorrelation();
+  }
+}
+
 
-    residuals_ = data_double_ - tmp_means;
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+void CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::calculateResiduals(void) const
+{
+  if (update_residuals_) {
+    // broadcast the mean across the filled rows only; the rest of the 
+    //  window holds no data yet
+    residuals_.topRows(num_used_data_) = 
+      data_.topRows(num_used_data_).template cast<double>().rowwise() 
+      - mean_.transpose();
     update_residuals_ = false;
 
     //std::cout << residuals_ << std::endl;
   }
 }
 
+
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+void CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::addToStatistics(int count)
+{
+  if (compensated_) {
+    covariance_kernels::Dispatch<_Dimension>::template 
+      run<covariance_kernels::PackedCompensatedWelfordAdd>(
+        dimension_, count, sample_.data(), mean_.data(), 
+        mean_compensation_.data(), comoment_.data(), 
+        comoment_compensation_.data(), delta_.data());
+  } else {
+    covariance_kernels::Dispatch<_Dimension>::template 
+      run<covariance_kernels::PackedWelfordAdd>(dimension_, count, 
+                                                sample_.data(), mean_.data(), 
+                                                comoment_.data(), 
+                                                delta_.data());
+  }
+  // both kernels leave x - mean in delta_
+  const double n = static_cast<double>(count) + 1.0;
+  updateFactorizations((n - 1.0) / n);
+}
+
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+void CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::removeFromStatistics(int count)
+{
+  if (count <= 1) {
+    // removing the last datum leaves nothing behind; reset exactly so no 
+    //  rounding error carries over
+    mean_.setZero();
+    comoment_.setZero();
+    if (compensated_) {
+      mean_compensation_.setZero();
+      comoment_compensation_.setZero();
+    }
+    invalidateFactorizations();
+    return;
+  }
+
+  if (compensated_) {
+    covariance_kernels::Dispatch<_Dimension>::template 
+      run<covariance_kernels::PackedCompensatedWelfordRemove>(
+        dimension_, count, sample_.data(), mean_.data(), 
+        mean_compensation_.data(), comoment_.data(), 
+        comoment_compensation_.data(), delta_.data());
+  } else {
+    covariance_kernels::Dispatch<_Dimension>::template 
+      run<covariance_kernels::PackedWelfordRemove>(dimension_, count, 
+                                                   sample_.data(), 
+                                                   mean_.data(), 
+                                                   comoment_.data(), 
+                                                   delta_.data());
+  }
+  const double n = static_cast<double>(count);
+  updateFactorizations(-n / (n - 1.0));
+}
+
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+void CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::updateFactorizations(double weight)
+{
+  // the updates accumulate rounding error whether or not the statistics are
+  //  re-anchored, so factorize from scratch once per window's worth of them
+  if ((cholesky_current_ || precision_current_)
+      && ++factorization_updates_ >= data_length_)
+    invalidateFactorizations();
+
+  if (cholesky_current_) {
+    if (cholesky_tracking_) {
+      comoment_llt_.rankUpdate(delta_, weight);
+      // a failed or nearly singular downdate leaves the factor unusable; 
+      //  start over on the next query
+      if (comoment_llt_.info() != Eigen::Success || !isConditioned())
+        cholesky_current_ = false;
+    } else {
+      cholesky_current_ = false;
+    }
+  }
+
+  if (precision_current_) {
+    if (precision_tracking_) {
+      // Sherman-Morrison: with u = P * d,
+      //  (C + w * d * d^T)^-1 = P - (w / (1 + w * d^T * u)) * u * u^T
+      precision_scratch_.noalias() = inverse_comoment_ * delta_;
+      const double denominator = 1.0 + weight * delta_.dot(precision_scratch_);
+      // measured against the inverse's own scale, its trace: an update 
+      //  that nearly cancels the inverse, or a downdate whose denominator is
+      //  mostly rounding error, amplifies the error relative to the result
+      const double scale = inverse_comoment_.trace();
+      const double term = weight / denominator 
+                          * precision_scratch_.squaredNorm();
+      const double result = scale - term;
+      if (!(denominator > 0.0) || !(result > 0.0)
+          || scale + std::abs(term) / denominator 
+             > kMaxShermanMorrisonAmplification * result) {
+        precision_current_ = false;
+      } else {
+        covariance_kernels::Dispatch<_Dimension>::template 
+          run<covariance_kernels::RankUpdate>(dimension_, 
+                                              -weight / denominator, 
+                                              precision_scratch_.data(), 
+                                              inverse_comoment_.data());
+        // a positive definite inverse has a positive diagonal
+        if (!(inverse_comoment_.diagonal().minCoeff() > 0.0))
+          precision_current_ = false;
+      }
+    } else {
+      precision_current_ = false;
+    }
+  }
+}
+
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+bool CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::invertComoment(void) const
+{
+  if (precision_current_ && num_used_data_ > dimension_)
+    return true;
+  if (!factorizeCholesky())
+    return false;
+
+  inverse_comoment_.setIdentity(dimension_, dimension_);
+  comoment_llt_.solveInPlace(inverse_comoment_);
+  precision_current_ = true;
+  return true;
+}
+
+/**
+ * const Eigen::Matrix<double, _Dimension, _Dimension>& getPrecision(void) 
+ *   const
+ *
+ * @return The inverse of the covariance matrix.
+ */
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+const Eigen::Matrix<double, _Dimension, _Dimension> &
+CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::getPrecision(void) const
+{
+  if (update_precision_) {
+    if (invertComoment()) {
+      // (comoment / (n - 1))^-1 = (n - 1) * comoment^-1
+      precision_ = inverse_comoment_ 
+                   * (static_cast<double>(num_used_data_) - 1.0);
+    } else {
+      precision_.setZero();
+    }
+    update_precision_ = false;
+  }
+  return precision_;
+}
+
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+bool CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::factorizeCholesky(void) const
+{
+  // the co-moment of dimension_ or fewer data has rank below dimension_, 
+  //  however well its rounded factor happens to come out
+  if (num_used_data_ <= dimension_)
+    return false;
+  if (cholesky_current_)
+    return true;
+
+  // cholesky_ is the scratch for the full co-moment, so its cache is stale
+  update_cholesky_ = true;
+  if (update_mode_ == INCREMENTAL) {
+    covariance_kernels::Dispatch<_Dimension>::template 
+      run<covariance_kernels::UnpackSymmetric>(dimension_, 1.0, 
+                                               comoment_.data(), 
+                                               cholesky_.data());
+  } else {
+    cholesky_ = getCovariance() 
+                * (static_cast<double>(num_used_data_) - 1.0);
+  }
+  comoment_llt_.compute(cholesky_);
+  factorization_updates_ = 0;
+  cholesky_current_ = (comoment_llt_.info() == Eigen::Success 
+                       && isConditioned());
+  return cholesky_current_;
+}
+
+/**
+ * const Eigen::Matrix<double, _Dimension, _Dimension>& getCholesky(void) 
+ *   const
+ *
+ * @return The lower-triangular Cholesky factor of the covariance.
+ */
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+const Eigen::Matrix<double, _Dimension, _Dimension> &
+CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::getCholesky(void) const
+{
+  if (update_cholesky_) {
+    if (factorizeCholesky()) {
+      // chol(comoment / (n - 1)) = chol(comoment) / sqrt(n - 1)
+      cholesky_ = comoment_llt_.matrixL();
+      cholesky_ /= std::sqrt(static_cast<double>(num_used_data_) - 1.0);
+    } else {
+      cholesky_.setZero();
+    }
+    update_cholesky_ = false;
+  }
+  return cholesky_;
+}
+
+/**
+ * Eigen::Matrix<double, _Dimension, 1> 
+ * solve(const Eigen::Matrix<double, _Dimension, 1> &b) const
+ *
+ * Solves getCovariance() * x = b.
+ */
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+Eigen::Matrix<double, _Dimension, 1> 
+CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::solve(const Eigen::Matrix<double, _Dimension, 1> &b) const
+{
+  assert(b.size() == dimension_);
+  if (!factorizeCholesky()) {
+    return Eigen::Matrix<double, _Dimension, 1>::Constant(
+      dimension_, std::numeric_limits<double>::quiet_NaN());
+  }
+  // covariance^-1 = (n - 1) * comoment^-1
+  Eigen::Matrix<double, _Dimension, 1> x = comoment_llt_.solve(b);
+  return x *= (static_cast<double>(num_used_data_) - 1.0);
+}
+
+/**
+ * double logDeterminant(void) const
+ *
+ * @return log(det(getCovariance())).
+ */
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+double CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::logDeterminant(void) const
+{
+  if (!factorizeCholesky())
+    return -std::numeric_limits<double>::infinity();
+  // det(comoment / (n - 1)) = det(L)^2 / (n - 1)^dimension
+  return 2.0 * comoment_llt_.matrixLLT().diagonal().array().log().sum()
+         - dimension_ * std::log(static_cast<double>(num_used_data_) - 1.0);
+}
+
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+void CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::addBlockToStatistics(int rows, int count)
+{
+  sample_ = residuals_.topRows(rows).colwise().sum().transpose() 
+            / static_cast<double>(rows);
+  residuals_.topRows(rows).rowwise() -= sample_.transpose();
+  mergeCenteredBlock(rows, count, mean_, comoment_);
+
+  if (shadow_count_ >= 0) {
+    if (shadow_count_ + rows > data_length_) {
+      // the shadow would include data that have already left the window
+      shadow_count_ = -1;
+    } else {
+      mergeCenteredBlock(rows, shadow_count_, shadow_mean_, shadow_comoment_);
+      shadow_count_ += rows;
+    }
+  }
+}
+
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+void CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::mergeCenteredBlock(int rows, int count,
+                     Eigen::Matrix<double, _Dimension, 1> &mean,
+                     PackedMatrix &comoment)
+{
+  // Chan et al.: with the block's mean b, co-moment B and d = b - mean,
+  //  mean += (rows / n) * d and
+  //  comoment += B + (count * rows / n) * d * d^T, where n = count + rows
+  const double n_a = static_cast<double>(count);
+  const double n_b = static_cast<double>(rows);
+  const double n = n_a + n_b;
+  delta_ = sample_ - mean;
+  mean += (n_b / n) * delta_;
+  accumulateGram(rows, 1.0, comoment);
+  covariance_kernels::Dispatch<_Dimension>::template 
+    run<covariance_kernels::PackedRankUpdate>(dimension_, n_a * n_b / n, 
+                                              delta_.data(), comoment.data());
+}
+
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+void CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::accumulateGram(int rows, double sign, PackedMatrix &comoment) const
+{
+  // column j of the upper triangle is the first j + 1 entries of R^T * r_j
+  const auto residuals = residuals_.topRows(rows);
+  for (int j = 0; j < dimension_; ++j) {
+    Eigen::Map<Eigen::VectorXd> column(comoment.data() + j * (j + 1) / 2, 
+                                       j + 1);
+    column.noalias() += 
+      sign * (residuals.leftCols(j + 1).transpose() * residuals.col(j));
+  }
+}
+
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+void CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::removeBlockFromStatistics(int rows, int count)
+{
+  if (rows >= count) {
+    // removing every datum leaves nothing behind
+    mean_.setZero();
+    comoment_.setZero();
+    if (compensated_) {
+      mean_compensation_.setZero();
+      comoment_compensation_.setZero();
+    }
+    return;
+  }
+
+  // the inverse of addBlockToStatistics(): with d = b - mean and 
+  //  r = count - rows remaining, mean -= (rows / r) * d and
+  //  comoment -= B + (count * rows / r) * d * d^T
+  const double n = static_cast<double>(count);
+  const double n_b = static_cast<double>(rows);
+  const double n_r = n - n_b;
+  sample_ = residuals_.topRows(rows).colwise().sum().transpose() / n_b;
+  delta_ = sample_ - mean_;
+  mean_ -= (n_b / n_r) * delta_;
+  residuals_.topRows(rows).rowwise() -= sample_.transpose();
+  accumulateGram(rows, -1.0, comoment_);
+  covariance_kernels::Dispatch<_Dimension>::template 
+    run<covariance_kernels::PackedRankUpdate>(dimension_, -n * n_b / n_r, 
+                                              delta_.data(), comoment_.data());
+}
+
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+void CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::recomputeStatistics(void)
+{
+  if (num_used_data_ == 0) {
+    mean_.setZero();
+    comoment_.setZero();
+    return;
+  }
+
+  reserveResiduals(num_used_data_);
+  residuals_.topRows(num_used_data_) = 
+    data_.topRows(num_used_data_).template cast<double>();
+  mean_ = residuals_.topRows(num_used_data_).colwise().sum().transpose()
+          / static_cast<double>(num_used_data_);
+  residuals_.topRows(num_used_data_).rowwise() -= mean_.transpose();
+  comoment_.setZero();
+  accumulateGram(num_used_data_, 1.0, comoment_);
+  if (compensated_) {
+    mean_compensation_.setZero();
+    comoment_compensation_.setZero();
+  }
+}
+
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+void CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::setCompensatedSummation(bool compensate)
+{
+  if (compensate && !compensated_) {
+    mean_compensation_.setZero(dimension_);
+    comoment_compensation_.setZero(comoment_.size());
+  }
+  compensated_ = compensate;
+}
+
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+void CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::setReanchorPeriod(int period)
+{
+  assert(period >= 0);
+  if (period > 0 && reanchor_period_ == 0) {
+    shadow_mean_.setZero(dimension_);
+    shadow_comoment_.setZero(comoment_.size());
+  }
+  reanchor_period_ = period;
+  shadow_count_ = -1;
+  since_anchor_ = 0;
+}
+
+template <typename _Scalar, int _Dimension, typename _Storage, int _Layout>
+void CovarianceTracker<_Scalar, _Dimension, _Storage, _Layout>
+::advanceReanchoring(int rows)
+{
+  if (reanchor_period_ == 0)
+    return;
+  since_anchor_ += rows;
+
+  if (shadow_count_ == data_length_ && num_used_data_ == data_length_) {
+    // the shadow saw exactly the data in the window, and never a downdate
+    mean_.swap(shadow_mean_);
+    comoment_.swap(shadow_comoment_);
+    invalidateFactorizations();
+    if (compensated_) {
+      mean_compensation_.setZero();
+      comoment_compensation_.setZero();
+    }
+    shadow_count_ = -1;
+    since_anchor_ = 0;
+  } else if (shadow_count_ < 0 && since_anchor_ >= reanchor_period_
+             && num_used_data_ == data_length_) {
+    // start from empty; the next data_length_ data will fill the shadow
+    shadow_mean_.setZero();
+    shadow_comoment_.setZero();
+    shadow_count_ = 0;
+  }
+}
+
 #endif // COVARIANCETRACKER_CPP
 
 #endif //COVARIANCETRACKER_H
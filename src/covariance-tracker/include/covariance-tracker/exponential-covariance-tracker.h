@@ -0,0 +1,240 @@
+/**
+ * The ExponentialCovarianceTracker class. Tracks an exponentially weighted
+ * (recency-weighted) mean and covariance of X-dimensional values without
+ * storing any of them.
+ *
+ * Where CovarianceTracker keeps a hard window of the last len data, this
+ * tracker weights datum k samples old by alpha * (1 - alpha)^k. It only keeps
+ * the mean and the covariance, so it needs O(_Dimension^2) memory and
+ * O(_Dimension^2) time per datum, and thousands of them fit where a handful
+ * of windowed trackers would.
+ *
+ * @author Vanderbilt Robotics
+ * @since October 2026
+ * @brief Calculate an exponentially weighted covariance, with no buffer.
+ */
+
+#ifndef EXPONENTIALCOVARIANCETRACKER_H
+#define EXPONENTIALCOVARIANCETRACKER_H
+
+#if __cplusplus <= 199711L
+  #error This library needs at least C++11! Compile with -std=c++11 or gnu++11.
+#endif
+
+#include <Eigen/Dense>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#include "covariance-kernels.h"
+
+
+template <typename _Scalar, int _Dimension>
+class ExponentialCovarianceTracker
+{
+public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  /**
+   * Constructor. The mean and covariance are set to 0.
+   *
+   * @param alpha The weight of each new datum, in (0, 1]. Larger values
+   *              forget faster. See halfLifeToAlpha() to configure by
+   *              half-life instead.
+   */
+  ExponentialCovarianceTracker(double alpha);
+
+  /**
+   * Constructor for a tracker whose dimension is chosen at runtime, i.e.
+   * _Dimension = Eigen::Dynamic.
+   *
+   * @param alpha The weight of each new datum, in (0, 1].
+   * @param dimension The number of variables in each datum.
+   */
+  ExponentialCovarianceTracker(double alpha, int dimension);
+
+  /**
+   * static double halfLifeToAlpha(double half_life)
+   *
+   * Example:
+   * <pre>
+   * {@code
+   * ExponentialCovarianceTracker<float, 3>
+   *   covtrack(ExponentialCovarianceTracker<float, 3>::halfLifeToAlpha(50));
+   * }
+   * </pre>
+   * @param half_life The number of data after which a datum's weight has
+   *                  halved. Must be positive.
+   * @return The alpha that gives that half-life.
+   */
+  static double halfLifeToAlpha(double half_life)
+  {
+    return 1.0 - std::pow(0.5, 1.0 / half_life);
+  }
+
+  /**
+   * double addData(Eigen::Matrix<_Scalar, _Dimension, 1> point)
+   *
+   * Folds the specified data point into the weighted mean and covariance.
+   * @param point The vector data point to add. Note this _must_ be a vector of
+   *              identical length to getDimension().
+   * @return The fraction of the steady-state weight accumulated so far,
+   *         1 - (1 - alpha)^n. Approaches 1 as data arrive.
+   */
+  double addData(const Eigen::Matrix<_Scalar, _Dimension, 1> &point);
+
+  /**
+   * double addData(const std::vector<_Scalar> point)
+   *
+   * Asserts the size of point is equal to getDimension()!
+   * @param point The std::vector<_Scalar> containing the data
+   * @return The fraction of the steady-state weight accumulated so far.
+   */
+  double addData(const std::vector<_Scalar> &point);
+
+  /**
+   * double addData(const _Scalar[] point)
+   *
+   * If the input array does not have a length getDimension(), memory will be
+   * grabbed that does not belong to the array.
+   * @param point The _Scalar array that contains the data point to add.
+   * @return The fraction of the steady-state weight accumulated so far.
+   */
+  double addData(const _Scalar point[]);
+
+  /**
+   * const Eigen::Matrix<>& getCovariance(void)
+   *
+   * @return The current weighted covariance matrix. Zero until two data have
+   *         been added.
+   */
+  const Eigen::Matrix<double, _Dimension, _Dimension> &getCovariance(void)
+    const
+  {
+    return covariance_;
+  }
+
+  /**
+   * const Eigen::Matrix<double, _Dimension, 1>& getMean(void)
+   *
+   * @return The current weighted mean. Zero until data have been added.
+   */
+  const Eigen::Matrix<double, _Dimension, 1> &getMean(void) const
+  {
+    return mean_;
+  }
+
+  /**
+   * double getAlpha(void)
+   *
+   * @return The weight of each new datum.
+   */
+  double getAlpha(void) const
+  {
+    return alpha_;
+  }
+
+  /**
+   * int getDimension(void)
+   *
+   * @return The dimension of this covariance tracker.
+   */
+  int getDimension(void) const
+  {
+    return dimension_;
+  }
+
+  /**
+   * double getFractionUsed(void)
+   *
+   * @return The fraction of the steady-state weight accumulated so far,
+   *         1 - (1 - alpha)^n.
+   */
+  double getFractionUsed(void) const
+  {
+    return 1.0 - remaining_weight_;
+  }
+
+private:
+  const double alpha_;
+  const int dimension_;
+  bool initialized_;
+  // (1 - alpha)^n, the weight the zero initial state would still carry.
+  double remaining_weight_;
+  Eigen::Matrix<double, _Dimension, 1> mean_;
+  Eigen::Matrix<double, _Dimension, _Dimension> covariance_;
+  // Scratch for the datum and its difference from the mean.
+  Eigen::Matrix<double, _Dimension, 1> sample_;
+  Eigen::Matrix<double, _Dimension, 1> delta_;
+};
+
+
+template <typename _Scalar, int _Dimension>
+ExponentialCovarianceTracker<_Scalar, _Dimension>
+::ExponentialCovarianceTracker(double alpha)
+  : ExponentialCovarianceTracker(alpha, _Dimension)
+{
+  static_assert(_Dimension != Eigen::Dynamic,
+    "An ExponentialCovarianceTracker with a runtime dimension needs the"
+    " dimension passed to its constructor.");
+}
+
+template <typename _Scalar, int _Dimension>
+ExponentialCovarianceTracker<_Scalar, _Dimension>
+::ExponentialCovarianceTracker(double alpha, int dimension)
+  : alpha_(alpha),
+    dimension_(dimension),
+    initialized_(false),
+    remaining_weight_(1.0),
+    mean_(Eigen::Matrix<double, _Dimension, 1>::Zero(dimension)),
+    covariance_(Eigen::Matrix<double, _Dimension, _Dimension>
+                ::Zero(dimension, dimension)),
+    sample_(dimension),
+    delta_(dimension)
+{
+  assert(alpha > 0.0 && alpha <= 1.0);
+  assert(dimension > 0);
+  assert(_Dimension == Eigen::Dynamic || dimension == _Dimension);
+}
+
+template <typename _Scalar, int _Dimension>
+double ExponentialCovarianceTracker<_Scalar, _Dimension>
+::addData(const Eigen::Matrix<_Scalar, _Dimension, 1> &point)
+{
+  assert(point.size() == dimension_);
+  return addData(point.data());
+}
+
+template <typename _Scalar, int _Dimension>
+double ExponentialCovarianceTracker<_Scalar, _Dimension>
+::addData(const std::vector<_Scalar> &point)
+{
+  assert(static_cast<int>(point.size()) == dimension_);
+  return addData(point.data());
+}
+
+template <typename _Scalar, int _Dimension>
+double ExponentialCovarianceTracker<_Scalar, _Dimension>
+::addData(const _Scalar point[])
+{
+  for (int i = 0; i < dimension_; ++i)
+    sample_(i) = static_cast<double>(point[i]);
+
+  if (initialized_) {
+    covariance_kernels::Dispatch<_Dimension>::template
+      run<covariance_kernels::ExponentialUpdate>(dimension_, alpha_,
+                                                 sample_.data(), mean_.data(),
+                                                 covariance_.data(),
+                                                 delta_.data());
+  } else {
+    // start from the first datum rather than from zero, so the mean is not
+    //  biased towards the origin while the weight builds up
+    mean_ = sample_;
+    initialized_ = true;
+  }
+
+  remaining_weight_ *= 1.0 - alpha_;
+  return getFractionUsed();
+}
+
+#endif // EXPONENTIALCOVARIANCETRACKER_H
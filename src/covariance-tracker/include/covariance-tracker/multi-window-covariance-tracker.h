@@ -0,0 +1,268 @@
+/**
+ * The MultiWindowCovarianceTracker class. Tracks the mean and covariance of
+ * the last N X-dimensional values for several window lengths N at once, e.g.
+ * short-, medium- and long-term noise estimates of one sensor stream.
+ *
+ * The data are stored once, in a ring buffer sized for the longest window,
+ * and each window keeps its own running statistics. Adding a datum costs one
+ * O(_Dimension^2) Welford downdate per full window, for the datum that just
+ * fell out of it, plus one Welford update per window. There is no shared
+ * work beyond the buffer write, since each window has its own mean.
+ *
+ * @author Vanderbilt Robotics
+ * @since October 2026
+ * @brief Calculate the covariance over several window lengths at once.
+ */
+
+#ifndef MULTIWINDOWCOVARIANCETRACKER_H
+#define MULTIWINDOWCOVARIANCETRACKER_H
+
+#if __cplusplus <= 199711L
+  #error This library needs at least C++11! Compile with -std=c++11 or gnu++11.
+#endif
+
+#include <Eigen/Dense>
+#include <Eigen/StdVector>
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+#include "covariance-statistics.h"
+
+
+template <typename _Scalar, int _Dimension>
+class MultiWindowCovarianceTracker
+{
+public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  /**
+   * Constructor. Every window starts empty. Example:
+   * <pre>
+   * {@code
+   * MultiWindowCovarianceTracker<double, 6> imu({50, 500, 5000});
+   * imu.addData(sample.data());
+   * Eigen::Matrix<double, 6, 6> shortTerm = imu.getCovariance(0);
+   * }
+   * </pre>
+   * @param lengths The number of data in each window, in any order. Windows
+   *                are referred to by their index in this list.
+   */
+  MultiWindowCovarianceTracker(const std::vector<int> &lengths);
+
+  /**
+   * Constructor for a tracker whose dimension is chosen at runtime, i.e.
+   * _Dimension = Eigen::Dynamic.
+   *
+   * @param lengths The number of data in each window.
+   * @param dimension The number of variables in each datum.
+   */
+  MultiWindowCovarianceTracker(const std::vector<int> &lengths,
+                               int dimension);
+
+  /**
+   * double addData(const _Scalar point[])
+   *
+   * Adds point to every window, evicting the oldest datum of each full one.
+   * @param point The getDimension() values of the datum.
+   * @return The fraction of the buffer (the longest window) that is used.
+   */
+  double addData(const _Scalar point[]);
+
+  /**
+   * double addData(const Eigen::Matrix<_Scalar, _Dimension, 1> &point)
+   *
+   * See addData() above.
+   */
+  double addData(const Eigen::Matrix<_Scalar, _Dimension, 1> &point)
+  {
+    assert(point.size() == getDimension());
+    return addData(point.data());
+  }
+
+  /**
+   * double addData(const std::vector<_Scalar> &point)
+   *
+   * See addData() above.
+   */
+  double addData(const std::vector<_Scalar> &point)
+  {
+    assert(static_cast<int>(point.size()) == getDimension());
+    return addData(point.data());
+  }
+
+  /**
+   * const Eigen::Matrix<double, _Dimension, _Dimension>&
+   *   getCovariance(int window) const
+   *
+   * @param window The index of the window.
+   * @return The covariance of its data, or zeros for fewer than two. Cached
+   *         until the next addData().
+   */
+  const Eigen::Matrix<double, _Dimension, _Dimension> &
+  getCovariance(int window) const;
+
+  /**
+   * const Eigen::Matrix<double, _Dimension, 1>& getMean(int window) const
+   *
+   * @param window The index of the window.
+   * @return The mean of its data; zero if there are none.
+   */
+  const Eigen::Matrix<double, _Dimension, 1> &getMean(int window) const
+  {
+    return getStatistics(window).getMean();
+  }
+
+  /**
+   * const CovarianceStatistics<_Dimension>& getStatistics(int window) const
+   *
+   * @param window The index of the window.
+   * @return The count, mean and co-moment of its data.
+   */
+  const CovarianceStatistics<_Dimension> &getStatistics(int window) const
+  {
+    assert(window >= 0 && window < getWindowCount());
+    return stats_[window];
+  }
+
+  /**
+   * int getWindowCount(void) const
+   *
+   * @return The number of windows.
+   */
+  int getWindowCount(void) const
+  {
+    return static_cast<int>(lengths_.size());
+  }
+
+  /**
+   * int getDataLength(int window) const
+   *
+   * @param window The index of the window.
+   * @return The number of data the window holds when full.
+   */
+  int getDataLength(int window) const
+  {
+    assert(window >= 0 && window < getWindowCount());
+    return lengths_[window];
+  }
+
+  /**
+   * int getCapacity(void) const
+   *
+   * @return The number of data in the buffer, the longest window's length.
+   */
+  int getCapacity(void) const
+  {
+    return capacity_;
+  }
+
+  /**
+   * int getDimension(void) const
+   *
+   * @return The number of variables in each datum.
+   */
+  int getDimension(void) const
+  {
+    return dimension_;
+  }
+
+  /**
+   * double getFractionUsed(void) const
+   *
+   * @return The fraction of the buffer that is used. (>= 0 and <= 1)
+   */
+  double getFractionUsed(void) const
+  {
+    return (static_cast<double>(num_used_data_)
+      / static_cast<double>(capacity_));
+  }
+
+private:
+  const std::vector<int> lengths_;
+  const int capacity_;  // The longest window.
+  const int dimension_;
+  int newest_data_;  // The slot of the newest datum.
+  int num_used_data_;  // The number of data in the buffer.
+  std::vector<double> data_;  // capacity_ data back to back.
+  // One per window. Fixed-size Eigen members need the aligned allocator.
+  std::vector<CovarianceStatistics<_Dimension>,
+              Eigen::aligned_allocator<CovarianceStatistics<_Dimension> > >
+    stats_;
+  // The covariance of each window, refreshed lazily by getCovariance().
+  mutable std::vector<bool> update_cov_;
+  mutable std::vector<Eigen::Matrix<double, _Dimension, _Dimension>,
+    Eigen::aligned_allocator<Eigen::Matrix<double, _Dimension, _Dimension> > >
+    covariances_;
+};
+
+
+template <typename _Scalar, int _Dimension>
+MultiWindowCovarianceTracker<_Scalar, _Dimension>
+::MultiWindowCovarianceTracker(const std::vector<int> &lengths)
+  : MultiWindowCovarianceTracker(lengths, _Dimension)
+{
+  static_assert(_Dimension != Eigen::Dynamic,
+    "A MultiWindowCovarianceTracker with a runtime dimension needs the"
+    " dimension passed to its constructor.");
+}
+
+template <typename _Scalar, int _Dimension>
+MultiWindowCovarianceTracker<_Scalar, _Dimension>
+::MultiWindowCovarianceTracker(const std::vector<int> &lengths, int dimension)
+  : lengths_(lengths),
+    capacity_(lengths.empty() ? 0
+              : *std::max_element(lengths.begin(), lengths.end())),
+    dimension_(dimension),
+    newest_data_(-1),
+    num_used_data_(0),
+    data_(static_cast<size_t>(capacity_) * dimension),
+    stats_(lengths.size(), CovarianceStatistics<_Dimension>(dimension)),
+    update_cov_(lengths.size(), false),
+    covariances_(lengths.size(), Eigen::Matrix<double, _Dimension, _Dimension>
+                                 ::Zero(dimension, dimension))
+{
+  assert(!lengths.empty()
+         && *std::min_element(lengths.begin(), lengths.end()) > 0);
+}
+
+template <typename _Scalar, int _Dimension>
+double MultiWindowCovarianceTracker<_Scalar, _Dimension>
+::addData(const _Scalar point[])
+{
+  newest_data_ = (newest_data_ + 1) % capacity_;
+
+  // the datum len slots back leaves each full window; for the longest one
+  //  that is the slot about to be overwritten, so evict before writing
+  for (int w = 0; w < getWindowCount(); ++w) {
+    if (stats_[w].getCount() == lengths_[w]) {
+      const int slot = (newest_data_ - lengths_[w] + capacity_) % capacity_;
+      stats_[w].remove(&data_[static_cast<size_t>(slot) * dimension_]);
+    }
+  }
+
+  double *datum = &data_[static_cast<size_t>(newest_data_) * dimension_];
+  for (int i = 0; i < dimension_; ++i)
+    datum[i] = static_cast<double>(point[i]);
+  for (int w = 0; w < getWindowCount(); ++w)
+    stats_[w].add(datum);
+  std::fill(update_cov_.begin(), update_cov_.end(), true);
+
+  num_used_data_ = std::min(num_used_data_ + 1, capacity_);
+  return getFractionUsed();
+}
+
+template <typename _Scalar, int _Dimension>
+const Eigen::Matrix<double, _Dimension, _Dimension> &
+MultiWindowCovarianceTracker<_Scalar, _Dimension>
+::getCovariance(int window) const
+{
+  assert(window >= 0 && window < getWindowCount());
+  if (update_cov_[window]) {
+    covariances_[window] = stats_[window].getCovariance();
+    update_cov_[window] = false;
+  }
+  return covariances_[window];
+}
+
+#endif // MULTIWINDOWCOVARIANCETRACKER_H
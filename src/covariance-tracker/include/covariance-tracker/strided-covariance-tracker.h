@@ -0,0 +1,293 @@
+/**
+ * The StridedCovarianceTracker class. Emits the mean and covariance of the
+ * last len X-dimensional values once every stride values, instead of on
+ * every insertion: a tumbling window when stride == len, a hopping window
+ * when stride < len.
+ *
+ * An insertion that does not complete a stride only copies the datum into a
+ * block buffer. When the block fills, its statistics are computed in one
+ * two-pass sweep over the contiguous block, and the statistics of the last
+ * len / stride blocks are merged (Chan et al.) into the emitted window. The
+ * results go to a callback, or into a queue that popResult() drains.
+ *
+ * @author Vanderbilt Robotics
+ * @since October 2026
+ * @brief Emit a windowed covariance once per stride.
+ */
+
+#ifndef STRIDEDCOVARIANCETRACKER_H
+#define STRIDEDCOVARIANCETRACKER_H
+
+#if __cplusplus <= 199711L
+  #error This library needs at least C++11! Compile with -std=c++11 or gnu++11.
+#endif
+
+#include <Eigen/Dense>
+#include <Eigen/StdDeque>
+#include <Eigen/StdVector>
+#include <cassert>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <vector>
+
+#include "covariance-statistics.h"
+
+
+template <typename _Scalar, int _Dimension>
+class StridedCovarianceTracker
+{
+public:
+  typedef CovarianceStatistics<_Dimension> Statistics;
+  // Receives every emitted window; the statistics are only valid during the
+  //  call.
+  typedef std::function<void(const Statistics &)> Callback;
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  /**
+   * Constructor. Example:
+   * <pre>
+   * {@code
+   * // the covariance of the last 1000 samples, every 250 samples
+   * StridedCovarianceTracker<float, 3> log(1000, 250,
+   *   [](const CovarianceStatistics<3> &window) {
+   *     write(window.getCovariance());
+   *   });
+   * }
+   * </pre>
+   * @param len The number of data in each emitted window.
+   * @param stride The number of data between emissions. Must divide len.
+   * @param callback Called with each emitted window. If empty, the windows
+   *                 are queued for popResult() instead.
+   */
+  StridedCovarianceTracker(int len, int stride,
+                           const Callback &callback = Callback());
+
+  /**
+   * Constructor for a tracker whose dimension is chosen at runtime, i.e.
+   * _Dimension = Eigen::Dynamic.
+   *
+   * @param len The number of data in each emitted window.
+   * @param stride The number of data between emissions. Must divide len.
+   * @param dimension The number of variables in each datum.
+   * @param callback Called with each emitted window, or empty to queue them.
+   */
+  StridedCovarianceTracker(int len, int stride, int dimension,
+                           const Callback &callback = Callback());
+
+  /**
+   * bool addData(const _Scalar point[])
+   *
+   * Copies point into the current block. If that completes a stride and
+   * len data have been seen, emits the window ending with point.
+   * @param point The getDimension() values of the datum.
+   * @return True if a window was emitted.
+   */
+  bool addData(const _Scalar point[]);
+
+  /**
+   * bool addData(const Eigen::Matrix<_Scalar, _Dimension, 1> &point)
+   *
+   * See addData() above.
+   */
+  bool addData(const Eigen::Matrix<_Scalar, _Dimension, 1> &point)
+  {
+    assert(point.size() == getDimension());
+    return addData(point.data());
+  }
+
+  /**
+   * bool addData(const std::vector<_Scalar> &point)
+   *
+   * See addData() above.
+   */
+  bool addData(const std::vector<_Scalar> &point)
+  {
+    assert(static_cast<int>(point.size()) == getDimension());
+    return addData(point.data());
+  }
+
+  /**
+   * bool popResult(Statistics &out)
+   *
+   * Takes the oldest queued window, when there is no callback.
+   * @param out Receives the window's count, mean and co-moment.
+   * @return False if the queue was empty.
+   */
+  bool popResult(Statistics &out);
+
+  /**
+   * size_t getQueuedCount(void) const
+   *
+   * @return The number of emitted windows waiting for popResult().
+   */
+  size_t getQueuedCount(void) const
+  {
+    return queue_.size();
+  }
+
+  /**
+   * uint64_t getEmittedCount(void) const
+   *
+   * @return The number of windows emitted so far.
+   */
+  uint64_t getEmittedCount(void) const
+  {
+    return emitted_;
+  }
+
+  /**
+   * int getDataLength(void) const
+   *
+   * @return The number of data in each emitted window.
+   */
+  int getDataLength(void) const
+  {
+    return blocks_per_window_ * stride_;
+  }
+
+  /**
+   * int getStride(void) const
+   *
+   * @return The number of data between emissions.
+   */
+  int getStride(void) const
+  {
+    return stride_;
+  }
+
+  /**
+   * int getDimension(void) const
+   *
+   * @return The number of variables in each datum.
+   */
+  int getDimension(void) const
+  {
+    return static_cast<int>(block_.rows());
+  }
+
+private:
+  const int stride_;
+  const int blocks_per_window_;
+  int block_fill_;  // The number of data in block_.
+  int newest_block_;  // The slot of the newest summarized block.
+  int num_blocks_;  // The number of summarized blocks, up to a window's worth.
+  uint64_t emitted_;
+  // The current block, one datum per column so each write is contiguous.
+  Eigen::Matrix<double, _Dimension, Eigen::Dynamic> block_;
+  Eigen::Matrix<double, _Dimension, 1> block_mean_;
+  Eigen::Matrix<double, _Dimension, _Dimension> block_comoment_;
+  // The statistics of the last blocks_per_window_ blocks, as a ring.
+  std::vector<Statistics, Eigen::aligned_allocator<Statistics> > blocks_;
+  Statistics window_;
+  Callback callback_;
+  std::deque<Statistics, Eigen::aligned_allocator<Statistics> > queue_;
+
+  /**
+   * void summarizeBlock(void)
+   *
+   * Replaces the oldest block's statistics with the current block's, and
+   * empties the current block.
+   */
+  void summarizeBlock(void);
+
+  /**
+   * void emitWindow(void)
+   *
+   * Merges the stored blocks, oldest first, and delivers the result.
+   */
+  void emitWindow(void);
+};
+
+
+template <typename _Scalar, int _Dimension>
+StridedCovarianceTracker<_Scalar, _Dimension>
+::StridedCovarianceTracker(int len, int stride, const Callback &callback)
+  : StridedCovarianceTracker(len, stride, _Dimension, callback)
+{
+  static_assert(_Dimension != Eigen::Dynamic,
+    "A StridedCovarianceTracker with a runtime dimension needs the dimension"
+    " passed to its constructor.");
+}
+
+template <typename _Scalar, int _Dimension>
+StridedCovarianceTracker<_Scalar, _Dimension>
+::StridedCovarianceTracker(int len, int stride, int dimension,
+                           const Callback &callback)
+  : stride_(stride),
+    blocks_per_window_(len / stride),
+    block_fill_(0),
+    newest_block_(-1),
+    num_blocks_(0),
+    emitted_(0),
+    block_(dimension, stride),
+    block_mean_(dimension),
+    block_comoment_(dimension, dimension),
+    blocks_(len / stride, Statistics(dimension)),
+    window_(dimension),
+    callback_(callback),
+    queue_()
+{
+  assert(stride > 0 && len >= stride && len % stride == 0);
+}
+
+template <typename _Scalar, int _Dimension>
+bool StridedCovarianceTracker<_Scalar, _Dimension>
+::addData(const _Scalar point[])
+{
+  block_.col(block_fill_) =
+    Eigen::Map<const Eigen::Matrix<_Scalar, _Dimension, 1> >(
+      point, getDimension()).template cast<double>();
+  if (++block_fill_ < stride_)
+    return false;
+
+  summarizeBlock();
+  if (num_blocks_ < blocks_per_window_)
+    return false;
+  emitWindow();
+  return true;
+}
+
+template <typename _Scalar, int _Dimension>
+void StridedCovarianceTracker<_Scalar, _Dimension>::summarizeBlock(void)
+{
+  // exact two-pass statistics of the block; it is overwritten next anyway,
+  //  so the residuals replace the data in place
+  block_mean_ = block_.rowwise().sum() / static_cast<double>(stride_);
+  block_.colwise() -= block_mean_;
+  block_comoment_.noalias() = block_ * block_.transpose();
+
+  newest_block_ = (newest_block_ + 1) % blocks_per_window_;
+  blocks_[newest_block_] =
+    Statistics(stride_, block_mean_, block_comoment_);
+  if (num_blocks_ < blocks_per_window_)
+    ++num_blocks_;
+  block_fill_ = 0;
+}
+
+template <typename _Scalar, int _Dimension>
+void StridedCovarianceTracker<_Scalar, _Dimension>::emitWindow(void)
+{
+  window_.clear();
+  for (int k = 1; k <= blocks_per_window_; ++k)
+    window_.merge(blocks_[(newest_block_ + k) % blocks_per_window_]);
+  ++emitted_;
+
+  if (callback_)
+    callback_(window_);
+  else
+    queue_.push_back(window_);
+}
+
+template <typename _Scalar, int _Dimension>
+bool StridedCovarianceTracker<_Scalar, _Dimension>::popResult(Statistics &out)
+{
+  if (queue_.empty())
+    return false;
+  out = queue_.front();
+  queue_.pop_front();
+  return true;
+}
+
+#endif // STRIDEDCOVARIANCETRACKER_H
@@ -0,0 +1,327 @@
+/**
+ * The TimedCovarianceTracker class. Tracks the mean and covariance of the
+ * X-dimensional values received during the last window seconds, for sensors
+ * that arrive at variable rates or drop out.
+ *
+ * Each datum carries a timestamp. Adding a datum at time t first evicts
+ * every stored datum older than t - window, possibly several at once, each
+ * with an O(_Dimension^2) Welford downdate of the running statistics. The
+ * buffer starts small and doubles as needed, up to a configurable maximum
+ * number of data; past that, the oldest datum is evicted early.
+ *
+ * @author Vanderbilt Robotics
+ * @since October 2026
+ * @brief Calculate the covariance of the values in a sliding time window.
+ */
+
+#ifndef TIMEDCOVARIANCETRACKER_H
+#define TIMEDCOVARIANCETRACKER_H
+
+#if __cplusplus <= 199711L
+  #error This library needs at least C++11! Compile with -std=c++11 or gnu++11.
+#endif
+
+#include <Eigen/Dense>
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+#include "covariance-statistics.h"
+
+
+template <typename _Scalar, int _Dimension>
+class TimedCovarianceTracker
+{
+public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  /**
+   * Constructor. The covariance values are set to 0.
+   *
+   * @param window The length of the window, in the units of the timestamps
+   *               (e.g. seconds).
+   * @param max_len The most data the buffer may grow to hold. Defaults to
+   *                10000.
+   */
+  TimedCovarianceTracker(double window, int max_len = 10000);
+
+  /**
+   * Constructor for a tracker whose dimension is chosen at runtime, i.e.
+   * _Dimension = Eigen::Dynamic.
+   *
+   * @param window The length of the window.
+   * @param dimension The number of variables in each datum.
+   * @param max_len The most data the buffer may grow to hold.
+   */
+  TimedCovarianceTracker(double window, int dimension, int max_len);
+
+  /**
+   * int addData(double time, const _Scalar point[])
+   *
+   * Evicts every datum older than time - getWindow(), then adds point.
+   * Timestamps must not decrease. Example:
+   * <pre>
+   * {@code
+   * TimedCovarianceTracker<double, 2> gps(10.0);  // the last 10 seconds
+   * gps.addData(msg.header.stamp.toSec(), fix.data());
+   * }
+   * </pre>
+   * @param time The timestamp of the datum.
+   * @param point The getDimension() values of the datum.
+   * @return The number of data in the window.
+   */
+  int addData(double time, const _Scalar point[]);
+
+  /**
+   * int addData(double time,
+   *             const Eigen::Matrix<_Scalar, _Dimension, 1> &point)
+   *
+   * See addData() above.
+   */
+  int addData(double time, const Eigen::Matrix<_Scalar, _Dimension, 1> &point)
+  {
+    assert(point.size() == getDimension());
+    return addData(time, point.data());
+  }
+
+  /**
+   * int addData(double time, const std::vector<_Scalar> &point)
+   *
+   * See addData() above.
+   */
+  int addData(double time, const std::vector<_Scalar> &point)
+  {
+    assert(static_cast<int>(point.size()) == getDimension());
+    return addData(time, point.data());
+  }
+
+  /**
+   * int advanceTime(double time)
+   *
+   * Evicts every datum older than time - getWindow() without adding one,
+   * e.g. on a timer while the sensor has dropped out.
+   * @param time The current time. Must not precede the newest datum.
+   * @return The number of data in the window.
+   */
+  int advanceTime(double time);
+
+  /**
+   * const Eigen::Matrix<double, _Dimension, _Dimension>& getCovariance(void)
+   *   const
+   *
+   * @return The covariance of the data in the window, or zeros for fewer
+   *         than two. Cached until the window changes.
+   */
+  const Eigen::Matrix<double, _Dimension, _Dimension> &getCovariance(void)
+    const;
+
+  /**
+   * const Eigen::Matrix<double, _Dimension, 1>& getMean(void) const
+   *
+   * @return The mean of the data in the window; zero if there are none.
+   */
+  const Eigen::Matrix<double, _Dimension, 1> &getMean(void) const
+  {
+    return stats_.getMean();
+  }
+
+  /**
+   * const CovarianceStatistics<_Dimension>& getStatistics(void) const
+   *
+   * @return The count, mean and co-moment of the data in the window.
+   */
+  const CovarianceStatistics<_Dimension> &getStatistics(void) const
+  {
+    return stats_;
+  }
+
+  /**
+   * int getCount(void) const
+   *
+   * @return The number of data in the window.
+   */
+  int getCount(void) const
+  {
+    return size_;
+  }
+
+  /**
+   * double getWindow(void) const
+   *
+   * @return The length of the window.
+   */
+  double getWindow(void) const
+  {
+    return window_;
+  }
+
+  /**
+   * int getCapacity(void) const
+   *
+   * @return The number of data the buffer holds before it has to grow.
+   */
+  int getCapacity(void) const
+  {
+    return capacity_;
+  }
+
+  /**
+   * int getMaxLength(void) const
+   *
+   * @return The most data the buffer may grow to hold.
+   */
+  int getMaxLength(void) const
+  {
+    return max_len_;
+  }
+
+  /**
+   * int getDimension(void) const
+   *
+   * @return The number of variables in each datum.
+   */
+  int getDimension(void) const
+  {
+    return stats_.getDimension();
+  }
+
+private:
+  // The capacity the buffer starts with, unless max_len is smaller.
+  static const int kInitialCapacity = 16;
+
+  const double window_;
+  const int max_len_;
+  int capacity_;
+  int oldest_;  // The slot of the oldest datum.
+  int size_;  // The number of data in the window.
+  std::vector<double> times_;  // capacity_ timestamps.
+  std::vector<double> data_;  // capacity_ data back to back.
+  CovarianceStatistics<_Dimension> stats_;
+  mutable bool update_cov_;
+  mutable Eigen::Matrix<double, _Dimension, _Dimension> covariance_;
+
+  /**
+   * void evictOldest(void)
+   *
+   * Removes the oldest datum from the buffer and the statistics.
+   */
+  void evictOldest(void);
+
+  /**
+   * void grow(void)
+   *
+   * Doubles the capacity, up to max_len_, laying the data out oldest first.
+   */
+  void grow(void);
+};
+
+
+template <typename _Scalar, int _Dimension>
+TimedCovarianceTracker<_Scalar, _Dimension>
+::TimedCovarianceTracker(double window, int max_len)
+  : TimedCovarianceTracker(window, _Dimension, max_len)
+{
+  static_assert(_Dimension != Eigen::Dynamic,
+    "A TimedCovarianceTracker with a runtime dimension needs the dimension"
+    " passed to its constructor.");
+}
+
+template <typename _Scalar, int _Dimension>
+TimedCovarianceTracker<_Scalar, _Dimension>
+::TimedCovarianceTracker(double window, int dimension, int max_len)
+  : window_(window),
+    max_len_(max_len),
+    // a ternary rather than std::min, which would bind a reference to (and
+    //  so need a definition of) kInitialCapacity
+    capacity_(max_len < kInitialCapacity ? max_len : kInitialCapacity),
+    oldest_(0),
+    size_(0),
+    times_(capacity_),
+    data_(static_cast<size_t>(capacity_) * dimension),
+    stats_(dimension),
+    update_cov_(false),
+    covariance_(Eigen::Matrix<double, _Dimension, _Dimension>
+                ::Zero(dimension, dimension))
+{
+  assert(window > 0.0 && max_len > 0);
+}
+
+template <typename _Scalar, int _Dimension>
+int TimedCovarianceTracker<_Scalar, _Dimension>
+::addData(double time, const _Scalar point[])
+{
+  advanceTime(time);
+  if (size_ == capacity_) {
+    if (capacity_ < max_len_)
+      grow();
+    else
+      evictOldest();
+  }
+
+  const int dimension = getDimension();
+  const int slot = (oldest_ + size_) % capacity_;
+  double *datum = &data_[static_cast<size_t>(slot) * dimension];
+  for (int i = 0; i < dimension; ++i)
+    datum[i] = static_cast<double>(point[i]);
+  times_[slot] = time;
+  ++size_;
+
+  stats_.add(datum);
+  update_cov_ = true;
+  return size_;
+}
+
+template <typename _Scalar, int _Dimension>
+int TimedCovarianceTracker<_Scalar, _Dimension>::advanceTime(double time)
+{
+  assert(size_ == 0
+         || time >= times_[(oldest_ + size_ - 1) % capacity_]);
+  const double cutoff = time - window_;
+  while (size_ > 0 && times_[oldest_] < cutoff)
+    evictOldest();
+  return size_;
+}
+
+template <typename _Scalar, int _Dimension>
+void TimedCovarianceTracker<_Scalar, _Dimension>::evictOldest(void)
+{
+  stats_.remove(&data_[static_cast<size_t>(oldest_) * getDimension()]);
+  oldest_ = (oldest_ + 1) % capacity_;
+  --size_;
+  update_cov_ = true;
+}
+
+template <typename _Scalar, int _Dimension>
+void TimedCovarianceTracker<_Scalar, _Dimension>::grow(void)
+{
+  const int dimension = getDimension();
+  const int capacity = std::min(2 * capacity_, max_len_);
+  std::vector<double> times(capacity);
+  std::vector<double> data(static_cast<size_t>(capacity) * dimension);
+
+  // unwrap the ring so the data start at slot 0
+  for (int k = 0; k < size_; ++k) {
+    const int slot = (oldest_ + k) % capacity_;
+    times[k] = times_[slot];
+    std::copy(data_.begin() + static_cast<size_t>(slot) * dimension,
+              data_.begin() + static_cast<size_t>(slot + 1) * dimension,
+              data.begin() + static_cast<size_t>(k) * dimension);
+  }
+  times_.swap(times);
+  data_.swap(data);
+  capacity_ = capacity;
+  oldest_ = 0;
+}
+
+template <typename _Scalar, int _Dimension>
+const Eigen::Matrix<double, _Dimension, _Dimension> &
+TimedCovarianceTracker<_Scalar, _Dimension>::getCovariance(void) const
+{
+  if (update_cov_) {
+    covariance_ = stats_.getCovariance();
+    update_cov_ = false;
+  }
+  return covariance_;
+}
+
+#endif // TIMEDCOVARIANCETRACKER_H
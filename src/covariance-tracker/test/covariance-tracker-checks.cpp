@@ -0,0 +1,251 @@
+/**
+ * Regression checks for the covariance-tracker headers. Built by default
+ * with the package's own flags (unoptimized unless a build type is set), so
+ * it also catches header constructs that only link with optimization, like
+ * an ODR-used static member that was never defined. Every tracker class is
+ * instantiated here for that reason.
+ *
+ * Exits with the number of failed checks.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <vector>
+
+#include "covariance-tracker/async-covariance-tracker.h"
+#include "covariance-tracker/covariance-tracker-bank.h"
+#include "covariance-tracker/covariance-tracker.h"
+#include "covariance-tracker/exponential-covariance-tracker.h"
+#include "covariance-tracker/multi-window-covariance-tracker.h"
+#include "covariance-tracker/strided-covariance-tracker.h"
+#include "covariance-tracker/timed-covariance-tracker.h"
+
+
+static int failures = 0;
+
+#define CHECK(condition)                                              \
+  do {                                                                \
+    if (!(condition)) {                                               \
+      std::printf("%s:%d: check failed: %s\n", __FILE__, __LINE__,   \
+                  #condition);                                        \
+      ++failures;                                                     \
+    }                                                                 \
+  } while (0)
+
+/**
+ * Eigen::Matrix3d sampleCovariance(const std::deque<Eigen::Vector3d> &data)
+ *
+ * @return The two-pass sample covariance of data, for reference.
+ */
+static Eigen::Matrix3d sampleCovariance(const std::deque<Eigen::Vector3d>
+                                        &data)
+{
+  Eigen::Vector3d mean = Eigen::Vector3d::Zero();
+  for (const Eigen::Vector3d &x : data)
+    mean += x;
+  mean /= static_cast<double>(data.size());
+  Eigen::Matrix3d covariance = Eigen::Matrix3d::Zero();
+  for (const Eigen::Vector3d &x : data)
+    covariance += (x - mean) * (x - mean).transpose();
+  return covariance / (static_cast<double>(data.size()) - 1.0);
+}
+
+/**
+ * A correlated, well-conditioned 3-vector for datum k.
+ */
+static Eigen::Vector3d sample(int k)
+{
+  const double t = static_cast<double>(k);
+  const double a = std::sin(0.7 * t);
+  return Eigen::Vector3d(a, std::cos(1.3 * t) + 0.5 * a,
+                         std::sin(2.9 * t + 1.0));
+}
+
+static void checkTimedTracker(void)
+{
+  // the window holds the data of the last 10 time units, at most 64 of
+  //  them; data arrive three per time unit, with a dropout in the middle
+  TimedCovarianceTracker<double, 3> timed(10.0, 64);
+  std::deque<Eigen::Vector3d> window;
+  std::deque<double> times;
+  for (int k = 0; k < 200; ++k) {
+    const double time = (k / 3) + ((k >= 100) ? 25.0 : 0.0);
+    const Eigen::Vector3d x = sample(k);
+    timed.addData(time, x);
+    window.push_back(x);
+    times.push_back(time);
+    while (times.front() < time - 10.0 || window.size() > 64) {
+      times.pop_front();
+      window.pop_front();
+    }
+    CHECK(timed.getCount() == static_cast<int>(window.size()));
+    if (window.size() > 1)
+      CHECK((timed.getCovariance() - sampleCovariance(window)).norm()
+            < 1e-12);
+  }
+  CHECK(timed.getCapacity() <= timed.getMaxLength());
+}
+
+static void checkRankDeficientFactorization(void)
+{
+  typedef CovarianceTracker<double, 3> Tracker;
+  const Tracker::UpdateMode modes[2] = {Tracker::INCREMENTAL,
+                                        Tracker::RECOMPUTE};
+  for (Tracker::UpdateMode mode : modes) {
+    // three data in three dimensions only span a plane, however well the
+    //  rounded co-moment factorizes
+    Tracker tracker(16, mode);
+    tracker.setCholeskyTracking(true);
+    tracker.setPrecisionTracking(true);
+    for (int k = 0; k < 3; ++k) {
+      tracker.addData(sample(k));
+      CHECK(tracker.getCholesky().isZero(0.0));
+      CHECK(tracker.getPrecision().isZero(0.0));
+      CHECK(std::isinf(tracker.logDeterminant()));
+      CHECK(std::isnan(tracker.solve(Eigen::Vector3d::Ones())(0)));
+    }
+    tracker.addData(sample(3));
+    CHECK(std::isfinite(tracker.logDeterminant()));
+    CHECK((tracker.getPrecision() * tracker.getCovariance()
+           - Eigen::Matrix3d::Identity()).norm() < 1e-9);
+
+    // collinear data stay rank-deficient however many there are
+    Tracker collinear(16, mode);
+    for (int k = 0; k < 16; ++k)
+      collinear.addData(Eigen::Vector3d(1.0, 2.0, -1.0) * sample(k)(0));
+    CHECK(collinear.getCholesky().isZero(0.0));
+    CHECK(std::isinf(collinear.logDeterminant()));
+  }
+}
+
+static void checkPrecisionRampUp(void)
+{
+  // the tracked inverse must agree with an exact one from the first datum
+  //  on which the covariance is invertible, through filling the window, to
+  //  well after data start leaving it
+  typedef CovarianceTracker<double, 3> Tracker;
+  Tracker tracked(12, Tracker::INCREMENTAL);
+  tracked.setCholeskyTracking(true);
+  tracked.setPrecisionTracking(true);
+  Tracker exact(12, Tracker::INCREMENTAL);
+  for (int k = 0; k < 60; ++k) {
+    tracked.addData(sample(k));
+    exact.addData(sample(k));
+    const Eigen::Matrix3d &precision = tracked.getPrecision();
+    if (k < 3) {
+      CHECK(precision.isZero(0.0));
+      continue;
+    }
+    const Eigen::Matrix3d reference = exact.getCovariance().inverse();
+    CHECK((precision - reference).norm() < 1e-9 * reference.norm());
+    CHECK(std::abs(tracked.logDeterminant()
+                   - std::log(exact.getCovariance().determinant())) < 1e-9);
+  }
+}
+
+template <int _Layout>
+static void checkBatchesAndResizes(void)
+{
+  // INCREMENTAL mode stages batches and evictions in a buffer that only 
+  //  grows as large as they are, so vary both around the window length
+  typedef CovarianceTracker<double, 3, float, _Layout> Tracker;
+  const int lengths[6] = {16, 5, 40, 9, 9, 64};
+  const int counts[6] = {3, 20, 7, 50, 1, 30};
+  Tracker incremental(16, Tracker::INCREMENTAL);
+  Tracker recompute(16, Tracker::RECOMPUTE);
+  std::deque<Eigen::Vector3d> window;
+  int k = 0;
+  for (int step = 0; step < 6; ++step) {
+    incremental.resize(lengths[step]);
+    recompute.resize(lengths[step]);
+    Eigen::Matrix<double, Eigen::Dynamic, 3> batch(counts[step], 3);
+    for (int i = 0; i < counts[step]; ++i, ++k) {
+      // exactly representable in float, so _Storage loses nothing
+      batch.row(i) = (sample(k) * 256.0).array().round().matrix().transpose();
+      window.push_back(batch.row(i).transpose());
+    }
+    incremental.addBatch(batch);
+    recompute.addBatch(batch);
+    while (static_cast<int>(window.size()) > lengths[step])
+      window.pop_front();
+
+    const Eigen::Matrix3d reference = sampleCovariance(window);
+    CHECK(incremental.getStatistics().getCount() == static_cast<int>(window.size()));
+    CHECK((incremental.getCovariance() - reference).norm()
+          < 1e-9 * reference.norm());
+    CHECK((recompute.getCovariance() - reference).norm()
+          < 1e-9 * reference.norm());
+  }
+}
+
+static void checkMultiWindow(void)
+{
+  // every window against its own brute-force copy, querying each twice per
+  //  datum so a stale cached covariance would show
+  const std::vector<int> lengths = {5, 17, 8};
+  MultiWindowCovarianceTracker<double, 3> multi(lengths);
+  std::deque<Eigen::Vector3d> windows[3];
+  for (int k = 0; k < 60; ++k) {
+    multi.addData(sample(k));
+    for (int w = 0; w < 3; ++w) {
+      windows[w].push_back(sample(k));
+      if (static_cast<int>(windows[w].size()) > lengths[w])
+        windows[w].pop_front();
+      if (windows[w].size() < 2)
+        continue;
+      const Eigen::Matrix3d reference = sampleCovariance(windows[w]);
+      CHECK((multi.getCovariance(w) - reference).norm() < 1e-12);
+      CHECK(multi.getCovariance(w) == multi.getStatistics(w).getCovariance());
+    }
+  }
+}
+
+static void instantiateEveryTracker(void)
+{
+  const float point[3] = {1.0f, 2.0f, 4.0f};
+  const float frame[6] = {1.0f, 2.0f, 4.0f, 3.0f, 1.0f, 0.0f};
+
+  CovarianceTracker<float, 3> recompute(8);
+  CovarianceTracker<float, Eigen::Dynamic, float, Eigen::RowMajor>
+    incremental(8, 3, CovarianceTracker<float, Eigen::Dynamic, float,
+                Eigen::RowMajor>::INCREMENTAL);
+  ExponentialCovarianceTracker<float, 3> exponential(0.1);
+  ConcurrentCovarianceTracker<float, 3> concurrent(8);
+  AsyncCovarianceTracker<float, 3> async(8, 16);
+  CovarianceTrackerBank<float, 3> bank(2, 8);
+  MultiWindowCovarianceTracker<float, 3> multi({4, 8});
+  StridedCovarianceTracker<float, 3> strided(8, 4);
+  CovarianceStatistics<3> statistics;
+
+  recompute.addData(point);
+  incremental.addData(point);
+  exponential.addData(point);
+  concurrent.addData(point);
+  async.push(point);
+  async.flush();
+  bank.addFrame(frame);
+  multi.addData(point);
+  strided.addData(point);
+  statistics.add(Eigen::Vector3d(1.0, 2.0, 4.0).data());
+
+  CHECK(recompute.getFractionUsed() > 0.0);
+  CHECK(incremental.getFractionUsed() > 0.0);
+  CHECK(multi.getStatistics(0).getCount() == 1);
+  CHECK(statistics.getCount() == 1);
+}
+
+int main()
+{
+  instantiateEveryTracker();
+  checkTimedTracker();
+  checkRankDeficientFactorization();
+  checkPrecisionRampUp();
+  checkBatchesAndResizes<Eigen::ColMajor>();
+  checkBatchesAndResizes<Eigen::RowMajor>();
+  checkMultiWindow();
+
+  if (failures == 0)
+    std::printf("All checks passed.\n");
+  return failures;
+}